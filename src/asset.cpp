@@ -7,6 +7,7 @@
 
 namespace asset{
 render::Texture GetTexture(const char* filepath){
+    PROFILE_FUNCTION();
     stbi_set_flip_vertically_on_load(true);
 
     int width, height, component_count;
@@ -25,5 +26,18 @@ render::Texture GetTexture(const char* filepath){
     stbi_image_free(data);
     return texture;
 }
-}
+// Decodes The Whole Image But Uploads Only Its Coarse Mips, The Streamer Refines It On Demand
+render::StreamingTexture* GetStreamingTexture(const char* filepath){
+    PROFILE_FUNCTION();
+    stbi_set_flip_vertically_on_load(true);
 
+    int width, height, component_count;
+    stbi_uc* data = stbi_load(filepath, &width, &height, &component_count, STBI_rgb_alpha);
+    if (!data) {
+        throw std::runtime_error("failed to load texture image!");
+    }
+    render::StreamingTexture* texture = render::texture_streamer.Create({(uint32_t)width, (uint32_t)height, 1}, data);
+    stbi_image_free(data);
+    return texture;
+}
+}
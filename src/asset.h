@@ -4,8 +4,13 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <cfloat>
+
 #include "render/mesh.h"
 #include "render/staging.h"
+#include "render/texture_streaming.h"
+#include "render/mesh_streaming.h"
+#include "profiler.h"
 
 namespace asset{
 enum Type{
@@ -15,41 +20,25 @@ enum Type{
 };
 
 render::Texture GetTexture(const char* filepath);
+render::StreamingTexture* GetStreamingTexture(const char* filepath);
 
-template<typename T>
-render::Mesh<T> GetMesh(const char* filepath){
-    Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(filepath,      
-                                             aiProcess_JoinIdenticalVertices |
-                                             aiProcess_Triangulate |
-                                             aiProcess_FlipUVs);
-    
-    if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode){
-        //cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
-        return;
-    }
-    uint32_t vertex_count = 0;
-    uint32_t index_count  = 0;
-    
+inline void CountMeshData(const aiScene* scene, uint32_t* vertex_count, uint32_t* index_count){
+    *vertex_count = 0;
+    *index_count  = 0;
     for(uint32_t i = 0; i < scene->mNumMeshes; i++){
-        vertex_count += scene->mMeshes[i]->mNumVertices;
+        *vertex_count += scene->mMeshes[i]->mNumVertices;
     }
     for(uint32_t mesh_i = 0; mesh_i < scene->mNumMeshes; mesh_i++){
         aiMesh* mesh = scene->mMeshes[mesh_i];
         for(uint32_t face_i = 0; face_i < mesh->mNumFaces; face_i++){
             aiFace face = mesh->mFaces[face_i];
-            index_count += face.mNumIndices;
+            *index_count += face.mNumIndices;
         }
     }
-    
-    printf("vert: %u, index: %u\n", vertex_count, index_count);
-    render::Mesh<T> render_mesh{};
-    render_mesh.Initialize(vertex_count, index_count);
-    T* vertex_destination =
-    (T*)render::staging_manager.UploadToTBAllocation(render::gpu_buffer, render_mesh.vertex_allocation);
-    uint32_t* index_destination =
-    (uint32_t*)render::staging_manager.UploadToTBAllocation(render::gpu_buffer, render_mesh.index_allocation);
-    
+}
+// Writes Every Submesh Into One Vertex And Index Range, Indices Rebased Onto The Combined Vertices
+template<typename T>
+void CopyMeshData(const aiScene* scene, T* vertex_destination, uint32_t* index_destination){
     for(uint32_t i = 0; i < scene->mNumMeshes; i++){
         aiMesh* mesh = scene->mMeshes[i];
         for(uint32_t vertex_index = 0; vertex_index < mesh->mNumVertices; vertex_index++){
@@ -94,8 +83,72 @@ render::Mesh<T> GetMesh(const char* filepath){
         }
         mesh_index_offset += mesh->mNumVertices;
     }
-    return render_mesh;
+}
+
+template<typename T>
+render::Mesh<T> GetMesh(const char* filepath){
+    PROFILE_FUNCTION();
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(filepath,      
+                                             aiProcess_JoinIdenticalVertices |
+                                             aiProcess_Triangulate |
+                                             aiProcess_FlipUVs);
+    
+    if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode){
+        //cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
+        return;
+    }
+    uint32_t vertex_count;
+    uint32_t index_count;
+    CountMeshData(scene, &vertex_count, &index_count);
+    
+    printf("vert: %u, index: %u\n", vertex_count, index_count);
+    render::Mesh<T> render_mesh{};
+    render_mesh.Initialize(vertex_count, index_count);
+    T* vertex_destination =
+    (T*)render::staging_manager.UploadToTBAllocation(render::gpu_buffer, render_mesh.vertex_allocation);
+    uint32_t* index_destination =
+    (uint32_t*)render::staging_manager.UploadToTBAllocation(render::gpu_buffer, render_mesh.index_allocation);
+    
+    CopyMeshData(scene, vertex_destination, index_destination);
     return render_mesh;
 };
-}
 
+// Keeps The Mesh On The CPU And Leaves Placement In gpu_buffer To The Mesh Streamer
+template<typename T>
+render::StreamingMesh* GetStreamingMesh(const char* filepath){
+    PROFILE_FUNCTION();
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(filepath,
+                                             aiProcess_JoinIdenticalVertices |
+                                             aiProcess_Triangulate |
+                                             aiProcess_FlipUVs);
+    
+    if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode){
+        throw std::runtime_error("FAILED TO LOAD MESH");
+    }
+    uint32_t vertex_count;
+    uint32_t index_count;
+    CountMeshData(scene, &vertex_count, &index_count);
+    
+    // Vertex Structs Hold Unions Of glm Types And Are Not Default Constructible, So Write Into Raw Bytes
+    std::vector<uint8_t>  vertices((size_t)vertex_count * sizeof(T));
+    std::vector<uint32_t> indices(index_count);
+    CopyMeshData(scene, (T*)vertices.data(), indices.data());
+    
+    glm::vec3 minimum(FLT_MAX);
+    glm::vec3 maximum(-FLT_MAX);
+    for(uint32_t i = 0; i < scene->mNumMeshes; i++){
+        aiMesh* mesh = scene->mMeshes[i];
+        for(uint32_t vertex_index = 0; vertex_index < mesh->mNumVertices; vertex_index++){
+            const glm::vec3 position(mesh->mVertices[vertex_index].x, mesh->mVertices[vertex_index].y,
+                                     mesh->mVertices[vertex_index].z);
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+    }
+    const glm::vec3 center = (minimum + maximum) * 0.5f;
+    return render::mesh_streamer.Create(vertices.data(), sizeof(T), vertex_count, indices.data(), index_count,
+                                        center, glm::length(maximum - center));
+}
+}
@@ -0,0 +1,147 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "glm/gtc/constants.hpp"
+
+namespace benchmark{
+void CameraPath::Record(const render::Camera& camera){
+    keyframes.push_back({ camera.position, camera.yaw, camera.pitch });
+}
+void CameraPath::Save(const char* filepath){
+    std::ofstream file(filepath);
+    if(!file.is_open()){
+        throw std::runtime_error("FAILED TO WRITE CAMERA PATH");
+    }
+    file.precision(9);
+    for(const CameraKeyframe& keyframe : keyframes){
+        file << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+             << keyframe.yaw << " " << keyframe.pitch << "\n";
+    }
+}
+void CameraPath::Load(const char* filepath){
+    std::ifstream file(filepath);
+    if(!file.is_open()){
+        throw std::runtime_error("FAILED TO OPEN CAMERA PATH");
+    }
+    keyframes.clear();
+    CameraKeyframe keyframe{};
+    while(file >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+               >> keyframe.yaw >> keyframe.pitch){
+        keyframes.emplace_back(keyframe);
+    }
+    if(keyframes.empty()){
+        throw std::runtime_error("CAMERA PATH IS EMPTY");
+    }
+}
+void CameraPath::Orbit(uint32_t frame_count, glm::vec3 center, float radius){
+    keyframes.clear();
+    keyframes.reserve(frame_count);
+    for(uint32_t i = 0; i < frame_count; i++){
+        const float angle = glm::two_pi<float>() * (float)i / (float)frame_count;
+        CameraKeyframe keyframe{};
+        keyframe.position = center + glm::vec3(-cos(angle), 0.0f, -sin(angle)) * radius;
+        // Yaw Faces The Camera Back Towards The Center
+        keyframe.yaw   = glm::degrees(angle);
+        keyframe.pitch = 0.0f;
+        keyframes.emplace_back(keyframe);
+    }
+}
+void CameraPath::Apply(uint32_t frame, render::Camera* camera){
+    if(keyframes.empty()){
+        return;
+    }
+    const CameraKeyframe& keyframe = keyframes[frame % keyframes.size()];
+    camera->position = keyframe.position;
+    camera->yaw      = keyframe.yaw;
+    camera->pitch    = keyframe.pitch;
+}
+
+// Nearest Rank Percentiles Over The Sorted Samples
+SeriesStatistics ComputeStatistics(std::vector<float> samples){
+    SeriesStatistics statistics{};
+    if(samples.empty()){
+        return statistics;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](float p){
+        size_t rank = (size_t)std::ceil(p * samples.size());
+        return samples[std::min(std::max(rank, (size_t)1), samples.size()) - 1];
+    };
+    double sum = 0.0;
+    for(float sample : samples){
+        sum += sample;
+    }
+    statistics.min  = samples.front();
+    statistics.mean = (float)(sum / samples.size());
+    statistics.p50  = percentile(0.50f);
+    statistics.p95  = percentile(0.95f);
+    statistics.p99  = percentile(0.99f);
+    return statistics;
+}
+
+void FrameStatistics::AddFrame(float frame_milliseconds, float record_milliseconds, float submit_milliseconds,
+                               const std::vector<render::GpuTiming>& gpu_timings){
+    if(skipped_frame_count_ < warmup_frame_count){
+        skipped_frame_count_++;
+        return;
+    }
+    this->frame_milliseconds.emplace_back(frame_milliseconds);
+    this->record_milliseconds.emplace_back(record_milliseconds);
+    this->submit_milliseconds.emplace_back(submit_milliseconds);
+    
+    std::map<std::string, float> frame_gpu_milliseconds;
+    for(const render::GpuTiming& timing : gpu_timings){
+        frame_gpu_milliseconds[timing.name] += timing.milliseconds;
+    }
+    for(const auto& [name, milliseconds] : frame_gpu_milliseconds){
+        gpu_milliseconds[name].emplace_back(milliseconds);
+    }
+}
+
+static void WriteSeries(std::ostringstream& json, const char* name, const std::vector<float>& samples, bool last,
+                        const char* indent = "    "){
+    SeriesStatistics statistics = ComputeStatistics(samples);
+    json << indent << "\"" << name << "\": { "
+         << "\"min\": "  << statistics.min  << ", "
+         << "\"mean\": " << statistics.mean << ", "
+         << "\"p50\": "  << statistics.p50  << ", "
+         << "\"p95\": "  << statistics.p95  << ", "
+         << "\"p99\": "  << statistics.p99  << " }" << (last ? "\n" : ",\n");
+}
+std::string FrameStatistics::ToJson(const char* name){
+    std::ostringstream json;
+    json.precision(6);
+    json << std::fixed;
+    json << "{\n";
+    json << "  \"benchmark\": \"" << name << "\",\n";
+    json << "  \"frames\": " << frame_milliseconds.size() << ",\n";
+    json << "  \"warmup_frames\": " << warmup_frame_count << ",\n";
+    json << "  \"milliseconds\": {\n";
+    WriteSeries(json, "frame",  frame_milliseconds,  false);
+    WriteSeries(json, "record", record_milliseconds, false);
+    WriteSeries(json, "submit", submit_milliseconds, gpu_milliseconds.empty());
+    if(!gpu_milliseconds.empty()){
+        json << "    \"gpu\": {\n";
+        size_t i = 0;
+        for(const auto& [name, samples] : gpu_milliseconds){
+            WriteSeries(json, name.c_str(), samples, ++i == gpu_milliseconds.size(), "      ");
+        }
+        json << "    }\n";
+    }
+    json << "  }\n";
+    json << "}\n";
+    return json.str();
+}
+void FrameStatistics::WriteJson(const char* name, const char* filepath){
+    std::ofstream file(filepath);
+    if(!file.is_open()){
+        throw std::runtime_error("FAILED TO WRITE BENCHMARK RESULTS");
+    }
+    file << ToJson(name);
+}
+}
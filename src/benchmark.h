@@ -0,0 +1,56 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "render/camera.h"
+#include "render/gpu_profiler.h"
+
+namespace benchmark{
+struct CameraKeyframe{
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+// One Keyframe Per Frame, Replay Indexes By Frame Number So Runs Do Not Depend On Frame Time
+class CameraPath{
+public:
+    void Record(const render::Camera& camera);
+    void Save(const char* filepath);
+    void Load(const char* filepath);
+    // Deterministic Fallback When No Recorded Path Is Given
+    void Orbit(uint32_t frame_count, glm::vec3 center, float radius);
+    
+    void Apply(uint32_t frame, render::Camera* camera);
+    
+    std::vector<CameraKeyframe> keyframes;
+};
+
+struct SeriesStatistics{
+    float min;
+    float mean;
+    float p50;
+    float p95;
+    float p99;
+};
+SeriesStatistics ComputeStatistics(std::vector<float> samples);
+
+class FrameStatistics{
+public:
+    void AddFrame(float frame_milliseconds, float record_milliseconds, float submit_milliseconds,
+                  const std::vector<render::GpuTiming>& gpu_timings = {});
+    
+    std::string ToJson(const char* name);
+    void WriteJson(const char* name, const char* filepath);
+    
+    uint32_t warmup_frame_count = 0;
+    std::vector<float> frame_milliseconds;
+    std::vector<float> record_milliseconds;
+    std::vector<float> submit_milliseconds;
+    // Summed Per Zone Name When A Zone Is Recorded More Than Once In A Frame
+    std::map<std::string, std::vector<float>> gpu_milliseconds;
+    
+private:
+    uint32_t skipped_frame_count_ = 0;
+};
+}
@@ -1,10 +1,16 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 #include "thread_pool.h"
+#include "profiler.h"
+#include "metrics.h"
 #include "window.h"
 #include "input.h"
 #include "asset.h"
+#include "benchmark.h"
 
 #ifndef GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -87,34 +93,268 @@ void UpdateCamera(float delta_time){
 }
 
 render::Window window{};
+// Headless Runs Render Offscreen Without SDL, For Benchmarking On Machines With No Display
+bool headless = false;
+const VkExtent2D headless_extent = { 1280, 720 };
+const char* profile_trace_file = nullptr;
+const char* metrics_file       = nullptr;
+// Forces The Staging Path On Devices With Host Visible Device Local Memory
+bool disable_direct_upload = false;
+// Off By Default So Benchmarks Measure The Driver Alone, Enabled By --validation Or ENGINE_VALIDATION=1
+bool enable_validation = false;
 void Initialize(){
+    // JSON Files Get One Object Per Frame, Anything Else Is Written As CSV
+    const bool metrics_json = metrics_file != nullptr && strstr(metrics_file, ".json") != nullptr;
+    core::metrics.Initialize(metrics_file, metrics_json ? core::METRICS_FORMAT_JSON : core::METRICS_FORMAT_CSV);
+    
+    // Enabled Before Any Thread Starts So Every Thread Registers Under Its Name
+    if(profile_trace_file != nullptr){
+        core::profiler.Initialize();
+        PROFILE_THREAD("Main Thread");
+        std::cout << "Profiler Zone Overhead: " << core::profiler.MeasureZoneOverhead(100000) << " ns\n";
+    }
+    
     const uint32_t thread_count = 2;
     core::threadpool.Initialize(thread_count);
     
-    SDL_Init(SDL_INIT_EVERYTHING);
-    SDL_DisplayMode display_mode;
-    SDL_GetCurrentDisplayMode(0, &display_mode);
-
-    window.Initialize({"engine", display_mode.w, display_mode.h});
+    if(headless){
+        window.width  = (int)headless_extent.width;
+        window.height = (int)headless_extent.height;
+    }
+    else{
+        SDL_Init(SDL_INIT_EVERYTHING);
+        SDL_DisplayMode display_mode;
+        SDL_GetCurrentDisplayMode(0, &display_mode);
+        
+        window.Initialize({"engine", display_mode.w, display_mode.h});
+    }
 
     render::ContextInfo context_info{};
-    context_info.window = &window;
-    context_info.enable_validation_layers = true;
+    context_info.window   = headless ? nullptr : &window;
+    context_info.headless = headless;
+    const char* validation_environment = getenv("ENGINE_VALIDATION");
+    context_info.enable_validation_layers = enable_validation ||
+                                            (validation_environment != nullptr && strcmp(validation_environment, "1") == 0);
     context_info.applcation_name = "engine";
     context_info.engine_name = "engine";
     render::context.Initalize(context_info);
     
-    render::descriptor_allocator.Initialize();
+    render::descriptor_set_layout_cache.Initialize();
+    render::descriptor_update_template_cache.Initialize();
+    render::sampler_cache.Initialize();
+    render::image_view_cache.Initialize();
+    // One Descriptor Pool Set Per Frame For The Main, Record And Threadpool Threads
+    render::descriptor_allocator.Initialize(2, thread_count + 2);
+    render::bindless_table.Initialize(2);
+    render::shader_compiler.Initialize();
     render::pipeline_manager.Initialize();
+    render::pipeline_manager.not_ready_mode = render::PIPELINE_NOT_READY_SKIP;
+    render::memory_budget.Initialize();
     render::command_manager.Initialize();
-    render::staging_manager.Initialize();
-    render::gpu_buffer.Initialize({
-        1000000000,
+    render::gpu_profiler.Initialize(2);
+    render::staging_manager.Initialize(!disable_direct_upload);
+    // 64 MB Pages Up To The Previous 1 GB, Committed As Meshes Load
+    render::gpu_buffer.Initialize(render::staging_manager.DirectUploadBufferInfo({
+        64 * 1024 * 1024,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT  |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT  |
         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY, 0
-    });
+        VMA_MEMORY_USAGE_GPU_ONLY, 0,
+        render::MEMORY_CATEGORY_MESH
+    }), 16);
+    render::gpu_buffer_defragmenter.Initialize(&render::gpu_buffer);
+}
+
+// Compiles Permutations Of The Base Pipeline As Monolithic Pipelines, Then Again By Linking Pipeline Libraries;
+// Each Path Starts From Its Own Empty Pipeline Cache So Neither Reuses The Other's Results
+std::vector<render::Pipeline*> CompilePermutations(const render::PipelineInfo& base_info, uint32_t permutation_count){
+    std::vector<render::Pipeline*> pipelines{};
+    for(uint32_t i = 0; i < permutation_count; i++){
+        render::PipelineInfo info = base_info;
+        info.cull_mode           = (render::NGFX_CullMode) (i % 4);
+        info.front_face          = (render::NGFX_FrontFace)((i / 4) % 2);
+        info.depth_write_enabled = (i / 8)  % 2;
+        info.depth_test_enabled  = (i / 16) % 2;
+        pipelines.emplace_back(render::pipeline_manager.Compile(info));
+    }
+    for(render::Pipeline* pipeline : pipelines){
+        render::pipeline_manager.AwaitCompilation(pipeline);
+    }
+    return pipelines;
+}
+VkPipelineCache CreateEmptyPipelineCache(){
+    VkPipelineCacheCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    VkPipelineCache vk_pipeline_cache;
+    if(vkCreatePipelineCache(render::context.vk_device, &create_info, nullptr, &vk_pipeline_cache) != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE BENCHMARK PIPELINE CACHE");
+    }
+    return vk_pipeline_cache;
+}
+void BenchmarkPipelinePermutations(render::PipelineInfo base_info, uint32_t permutation_count){
+    const uint32_t unique_permutation_count = 32;
+    permutation_count = std::min(permutation_count, unique_permutation_count);
+    
+    VkPipelineCache shared_pipeline_cache = render::pipeline_manager.vk_pipeline_cache;
+    for(bool use_pipeline_library : {false, true}){
+        if(use_pipeline_library && !render::context.graphics_pipeline_library_supported){
+            std::cout << "Pipeline Benchmark: VK_EXT_graphics_pipeline_library not supported\n";
+            break;
+        }
+        render::pipeline_manager.use_pipeline_library = use_pipeline_library;
+        std::vector<VkPipelineCache> benchmark_pipeline_caches{ CreateEmptyPipelineCache() };
+        render::pipeline_manager.vk_pipeline_cache = benchmark_pipeline_caches.back();
+        
+        // Libraries Outlive The Pipelines Linked From Them, So A First Pass Leaves Only Linking To Time
+        if(use_pipeline_library){
+            for(render::Pipeline* pipeline : CompilePermutations(base_info, permutation_count)){
+                render::pipeline_manager.Destroy(pipeline);
+            }
+            benchmark_pipeline_caches.emplace_back(CreateEmptyPipelineCache());
+            render::pipeline_manager.vk_pipeline_cache = benchmark_pipeline_caches.back();
+        }
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<render::Pipeline*> pipelines = CompilePermutations(base_info, permutation_count);
+        auto finish = std::chrono::high_resolution_clock::now();
+        float pipeline_milliseconds = 0.0f;
+        for(render::Pipeline* pipeline : pipelines){
+            pipeline_milliseconds += pipeline->compile_milliseconds;
+        }
+        
+        std::cout << "Pipeline Benchmark: " << permutation_count
+        << (use_pipeline_library ? " linked" : " monolithic") << " permutations, "
+        << std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() / 1000.0f
+        << " ms wall, " << pipeline_milliseconds << " ms in vkCreateGraphicsPipelines (empty cache)\n";
+        
+        for(render::Pipeline* pipeline : pipelines){
+            render::pipeline_manager.Destroy(pipeline);
+        }
+        for(VkPipelineCache vk_pipeline_cache : benchmark_pipeline_caches){
+            vkDestroyPipelineCache(render::context.vk_device, vk_pipeline_cache, nullptr);
+        }
+    }
+    render::pipeline_manager.vk_pipeline_cache = shared_pipeline_cache;
+    render::pipeline_manager.use_pipeline_library = true;
+}
+
+// Compares Per-Draw Descriptor Cost: Allocating And Writing A Set Then Binding It, Against Pushing The Same Writes
+void BenchmarkDescriptorPaths(render::DescriptorSetLayout set_layout,
+                              render::Sampler* sampler, render::Texture* texture, uint32_t draw_count){
+    if(!render::context.push_descriptor_supported){
+        std::cout << "Descriptor Benchmark: VK_KHR_push_descriptor not supported\n";
+        return;
+    }
+    render::PipelineInfo allocate_info{};
+    allocate_info.descriptor_set_layouts = { set_layout };
+    render::PipelineInfo push_info{};
+    push_info.descriptor_set_layouts = {
+        render::descriptor_set_layout_cache.Get(set_layout.bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR)
+    };
+    VkPipelineLayout allocate_layout = render::pipeline_manager.GetPipelineLayout(allocate_info);
+    VkPipelineLayout push_layout     = render::pipeline_manager.GetPipelineLayout(push_info);
+    
+    VkCommandPoolCreateInfo pool_create_info{};
+    pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_create_info.queueFamilyIndex = render::context.graphics_queue.vk_family_index;
+    VkCommandPool vk_command_pool;
+    vkCreateCommandPool(render::context.vk_device, &pool_create_info, nullptr, &vk_command_pool);
+    
+    VkCommandBufferAllocateInfo buffer_allocate_info{};
+    buffer_allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    buffer_allocate_info.commandPool = vk_command_pool;
+    buffer_allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    buffer_allocate_info.commandBufferCount = 1;
+    VkCommandBuffer vk_command_buffer;
+    vkAllocateCommandBuffers(render::context.vk_device, &buffer_allocate_info, &vk_command_buffer);
+    
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    
+    // Recorded But Never Submitted, Only Host Side Cost Is Measured
+    render::DescriptorWriter writer{};
+    vkBeginCommandBuffer(vk_command_buffer, &begin_info);
+    auto start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < draw_count; i++){
+        render::DescriptorSet descriptor_set = render::descriptor_allocator.Allocate(set_layout, 0);
+        sampler->WriteDescriptor(&writer, descriptor_set.vk_descriptor_set, 0, 0);
+        texture->WriteDescriptor(&writer, descriptor_set.vk_descriptor_set, 1, 0);
+        writer.Flush();
+        vkCmdBindDescriptorSets(vk_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, allocate_layout,
+                                0, 1, &descriptor_set.vk_descriptor_set, 0, nullptr);
+    }
+    auto allocate_finish = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < draw_count; i++){
+        sampler->WriteDescriptor(&writer, VK_NULL_HANDLE, 0, 0);
+        texture->WriteDescriptor(&writer, VK_NULL_HANDLE, 1, 0);
+        writer.Push(vk_command_buffer, push_layout, 0);
+    }
+    auto push_finish = std::chrono::high_resolution_clock::now();
+    vkEndCommandBuffer(vk_command_buffer);
+    
+    std::cout << "Descriptor Benchmark: " << draw_count << " draws, allocate and write "
+    << std::chrono::duration_cast<std::chrono::microseconds>(allocate_finish - start).count() / 1000.0f
+    << " ms, push "
+    << std::chrono::duration_cast<std::chrono::microseconds>(push_finish - allocate_finish).count() / 1000.0f
+    << " ms\n";
+    
+    vkDestroyCommandPool(render::context.vk_device, vk_command_pool, nullptr);
+}
+
+// Compares Uploading The Same Bytes Through The Staging Buffer And A Device Copy, Against Writing Them Straight
+// Into Host Visible Device Local Memory; Both Are Timed Until The Data Is Usable By The Device
+void BenchmarkUploadPaths(uint32_t upload_megabytes){
+    if(!render::staging_manager.direct_upload_supported){
+        std::cout << "Upload Benchmark: no host visible device local memory\n";
+        return;
+    }
+    // A Single Staged Upload Must Fit The Staging Buffer, Which Is Smaller While Direct Upload Is Enabled
+    const size_t upload_size = std::min((size_t)upload_megabytes * 1024 * 1024,
+                                        render::staging_manager.staging_buffer_size);
+    const render::BufferInfo buffer_info = {
+        upload_size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, 0,
+        render::MEMORY_CATEGORY_OTHER
+    };
+    const bool direct_upload_enabled = render::staging_manager.direct_upload_enabled;
+    render::staging_manager.direct_upload_enabled = true;
+    render::Buffer staged_buffer{};
+    staged_buffer.Initialize(buffer_info);
+    render::Buffer direct_buffer{};
+    direct_buffer.Initialize(render::staging_manager.DirectUploadBufferInfo(buffer_info));
+    if(direct_buffer.mapped_pointer == nullptr){
+        std::cout << "Upload Benchmark: direct buffer was not placed in host visible memory\n";
+    }
+    std::vector<uint8_t> data(upload_size);
+    for(size_t i = 0; i < upload_size; i++){
+        data[i] = (uint8_t)i;
+    }
+    
+    // Uploads Recorded Before The Benchmark Are Flushed So Only The Benchmark's Bytes Are Timed
+    render::staging_manager.SubmitUpload({});
+    render::staging_manager.AwaitUploadCompletion();
+    auto start = std::chrono::high_resolution_clock::now();
+    std::memcpy(render::staging_manager.UploadToBuffer(upload_size, 0, &staged_buffer), data.data(), upload_size);
+    render::staging_manager.SubmitUpload({});
+    render::staging_manager.AwaitUploadCompletion();
+    auto staged_finish = std::chrono::high_resolution_clock::now();
+    std::memcpy(render::staging_manager.UploadToBuffer(upload_size, 0, &direct_buffer), data.data(), upload_size);
+    render::staging_manager.SubmitUpload({});
+    auto direct_finish = std::chrono::high_resolution_clock::now();
+    
+    std::cout << "Upload Benchmark: " << upload_size / (1024 * 1024) << " MB, staged "
+    << std::chrono::duration_cast<std::chrono::microseconds>(staged_finish - start).count() / 1000.0f
+    << " ms, direct "
+    << std::chrono::duration_cast<std::chrono::microseconds>(direct_finish - staged_finish).count() / 1000.0f
+    << " ms\n";
+    
+    render::staging_manager.direct_upload_enabled = direct_upload_enabled;
+    staged_buffer.Terminate();
+    direct_buffer.Terminate();
 }
 
 MESH_VERTEX_STRUCT Vertex {
@@ -124,9 +364,119 @@ MESH_VERTEX_STRUCT Vertex {
 };
 
 int main(int argc, char** argv){
+    uint32_t frame_limit = UINT32_MAX;
+    // Replay Benchmarks Run Headless, Drive The Camera From A Path Instead Of Input And Report JSON
+    uint32_t replay_frame_count = 0;
+    const char* camera_path_file        = nullptr;
+    const char* record_camera_path_file = nullptr;
+    const char* benchmark_output_file   = nullptr;
+    bool stream_textures = false;
+    bool stream_meshes   = false;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--headless") == 0){
+            headless = true;
+        }
+        else if(strcmp(argv[i], "--stream-textures") == 0){
+            stream_textures = true;
+        }
+        else if(strcmp(argv[i], "--stream-meshes") == 0){
+            stream_meshes = true;
+        }
+        else if(strcmp(argv[i], "--no-direct-upload") == 0){
+            disable_direct_upload = true;
+        }
+        else if(strcmp(argv[i], "--validation") == 0){
+            enable_validation = true;
+        }
+        else if(i + 1 < argc){
+            if(strcmp(argv[i], "--frames") == 0){
+                frame_limit = (uint32_t)atoi(argv[i + 1]);
+            }
+            else if(strcmp(argv[i], "--benchmark-replay") == 0){
+                replay_frame_count = (uint32_t)atoi(argv[i + 1]);
+            }
+            else if(strcmp(argv[i], "--camera-path") == 0){
+                camera_path_file = argv[i + 1];
+            }
+            else if(strcmp(argv[i], "--record-camera-path") == 0){
+                record_camera_path_file = argv[i + 1];
+            }
+            else if(strcmp(argv[i], "--benchmark-output") == 0){
+                benchmark_output_file = argv[i + 1];
+            }
+            else if(strcmp(argv[i], "--profile-trace") == 0){
+                profile_trace_file = argv[i + 1];
+            }
+            else if(strcmp(argv[i], "--metrics-output") == 0){
+                metrics_file = argv[i + 1];
+            }
+        }
+    }
+    const bool replay = replay_frame_count > 0;
+    benchmark::CameraPath camera_path{};
+    benchmark::FrameStatistics frame_statistics{};
+    if(replay){
+        headless = true;
+        frame_statistics.warmup_frame_count = 16;
+        frame_limit = frame_statistics.warmup_frame_count + replay_frame_count;
+        if(camera_path_file != nullptr){
+            camera_path.Load(camera_path_file);
+        }
+        else{
+            camera_path.Orbit(replay_frame_count, glm::vec3(0.0f), 5.0f);
+        }
+    }
+    
     Initialize();
-    auto swapchain      = new render::Swapchain(&window);
-    auto render_buffer  = new render::RenderBuffer(swapchain);
+    auto swapchain      = headless ? new render::Swapchain(headless_extent, 2) : new render::Swapchain(&window);
+    
+    // The Forward Pass Draws Into A Transient Depth Image And The Acquired Swapchain Image, Whose Layout
+    // Transitions Are Issued By The Graph; Per Frame Inputs Are Set On The Record Thread Before Execute
+    struct ForwardPassData{
+        uint32_t image_index;
+        glm::mat4 view_projection;
+        render::DrawQueue* draw_queue;
+    };
+    ForwardPassData forward_pass_data{};
+    render::RenderBuffer* render_buffer = nullptr;
+    const render::ImageExtent swapchain_extent = { swapchain->extent_.width, swapchain->extent_.height, 1 };
+    render::FrameGraph frame_graph{};
+    frame_graph.Initialize();
+    render::FrameGraphResource depth_image = frame_graph.CreateImage("Depth", {
+        swapchain_extent, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+    });
+    render::FrameGraphResource swapchain_image = frame_graph.ImportImage("Swapchain", {
+        swapchain_extent, swapchain->surface_format_.format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+    }, VK_IMAGE_LAYOUT_UNDEFINED, swapchain->final_layout_);
+    frame_graph.AddPass("Forward", {
+        { depth_image,     render::FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE },
+        { swapchain_image, render::FRAME_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE },
+    }, [&render_buffer, &forward_pass_data, swapchain](VkCommandBuffer vk_command_buffer, render::FrameGraph* graph){
+        PROFILE_GPU_ZONE(vk_command_buffer, "Forward Pass");
+        render_buffer->Begin(vk_command_buffer, swapchain, forward_pass_data.image_index);
+        
+        VkViewport viewport{};
+        viewport.width  = swapchain->extent_.width;
+        viewport.height = swapchain->extent_.height;
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(vk_command_buffer, 0, 1, &viewport);
+        
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = swapchain->extent_;
+        vkCmdSetScissor(vk_command_buffer, 0, 1, &scissor);
+        
+        forward_pass_data.draw_queue->Record(vk_command_buffer, sizeof(glm::mat4),
+                                             (void*)&forward_pass_data.view_projection);
+        
+        vkCmdEndRenderPass(vk_command_buffer);
+    });
+    frame_graph.Compile();
+    render_buffer = new render::RenderBuffer(swapchain, frame_graph.GetView(depth_image));
     
     auto vertex_shader   = new render::Shader({
         render::SHADER_STAGE_VERTEX,   render::SHADER_FORMAT_SPIRV, "vert.spv"
@@ -135,15 +485,16 @@ int main(int argc, char** argv){
         render::SHADER_STAGE_FRAGMENT, render::SHADER_FORMAT_SPIRV, "frag.spv"
     });
     
-    auto set_layout = render::DescriptorSetLayout{};
-    set_layout.Initialize({
-        {0, VK_DESCRIPTOR_TYPE_SAMPLER,       1, render::SHADER_STAGE_FRAGMENT, nullptr},
-        {1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, render::SHADER_STAGE_FRAGMENT, nullptr},
-    });
+    auto set_layouts = render::pipeline_manager.ReflectDescriptorSetLayouts({ vertex_shader, fragment_shader });
+    // Empty When A Shader Failed To Compile Or Declares No Sets, The Frame Needs Set 0 For Its Texture
+    if(set_layouts.empty()){
+        throw std::runtime_error("SHADERS DECLARE NO DESCRIPTOR SET 0");
+    }
+    auto set_layout  = set_layouts[0];
     
+    // Push Constant Ranges And Descriptor Set Layouts Are Reflected From The Shaders,
+    // Vertex Input Is Given Explicitly Since Vertex Is Padded
     render::PipelineInfo pipeline_info{};
-    pipeline_info.push_constant_ranges   = { render::Camera::PushConstantRange(0), };
-    pipeline_info.descriptor_set_layouts = { set_layout, };
     pipeline_info.vertex_attributes = {
         render::MVS::PositionAttribute<Vertex>(0, 0),
         render::MVS::TextureCoordinate2DAttribute<Vertex>(1, 0),
@@ -157,16 +508,48 @@ int main(int argc, char** argv){
     pipeline_info.cull_mode  = render::NGFX_CULL_MODE_BACK_FACE;
     pipeline_info.depth_test_enabled = true;
     pipeline_info.depth_write_enabled = true;
+    
+    for(int i = 1; i + 1 < argc; i++){
+        if(strcmp(argv[i], "--benchmark-pipelines") == 0){
+            BenchmarkPipelinePermutations(pipeline_info, (uint32_t)atoi(argv[i + 1]));
+        }
+    }
+    
     render::Pipeline* pipeline = render::pipeline_manager.Compile(pipeline_info);
     
     uint32_t vertex_count = 0;
     uint32_t index_count  = 0;
 
-    auto mesh    = asset::GetMesh<Vertex>("backpack/backpack.obj");
-    auto texture = asset::GetTexture("backpack/diffuse.jpg");
+    // Streamed Meshes Only Occupy gpu_buffer While Near The Camera
+    render::Mesh<Vertex> mesh{};
+    render::StreamingMesh* streaming_mesh = nullptr;
+    if(stream_meshes){
+        render::mesh_streamer.Initialize();
+        streaming_mesh = asset::GetStreamingMesh<Vertex>("backpack/backpack.obj");
+    }
+    else{
+        mesh = asset::GetMesh<Vertex>("backpack/backpack.obj");
+    }
+    // Streamed Textures Start With Their Coarse Mips And Refine As The Camera Approaches
+    render::Texture texture{};
+    render::StreamingTexture* streaming_texture = nullptr;
+    render::SamplerInfo sampler_info{};
+    if(stream_textures){
+        render::texture_streamer.Initialize();
+        streaming_texture = asset::GetStreamingTexture("backpack/diffuse.jpg");
+        sampler_info.mag_filter  = VK_FILTER_LINEAR;
+        sampler_info.min_filter  = VK_FILTER_LINEAR;
+        sampler_info.mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        sampler_info.max_lod     = VK_LOD_CLAMP_NONE;
+    }
+    else{
+        texture = asset::GetTexture("backpack/diffuse.jpg");
+    }
+    render::Texture* material_texture = stream_textures ? &streaming_texture->texture : &texture;
     
     render::Sampler sampler{};
-    sampler.Initialize();
+    sampler.Initialize(sampler_info);
+    render::bindless_table.SetSampler(sampler.vk_sampler);
     
     /*render::Texture texture{};
     texture.Initialize({100, 100, 1});
@@ -177,9 +560,22 @@ int main(int argc, char** argv){
         ((uint8_t*)staging_pointer)[i] = rand() % UINT8_MAX;
     }*/
     
-    auto descriptor_set = render::descriptor_allocator.Allocate(set_layout);
-    sampler.WriteDescriptor(descriptor_set.vk_descriptor_set, 0, 0);
-    texture.WriteDescriptor(descriptor_set.vk_descriptor_set, 1, 0);
+    auto descriptor_set = render::descriptor_allocator.AllocatePersistent(set_layout);
+    // Bindings Are Written In Layout Order Through The Layout's Update Template
+    const render::DescriptorData descriptor_data[] = {
+        sampler.GetDescriptorData(),
+        material_texture->GetDescriptorData(),
+    };
+    render::descriptor_update_template_cache.Get(set_layout)->Update(descriptor_set.vk_descriptor_set, descriptor_data);
+    
+    for(int i = 1; i + 1 < argc; i++){
+        if(strcmp(argv[i], "--benchmark-descriptors") == 0){
+            BenchmarkDescriptorPaths(set_layout, &sampler, material_texture, (uint32_t)atoi(argv[i + 1]));
+        }
+        if(strcmp(argv[i], "--benchmark-uploads") == 0){
+            BenchmarkUploadPaths((uint32_t)atoi(argv[i + 1]));
+        }
+    }
     
     render::staging_manager.SubmitUpload({});
     
@@ -199,111 +595,230 @@ int main(int argc, char** argv){
     swapchain_semaphore[0].Initialize();
     swapchain_semaphore[1].Initialize();
     
-    render::pipeline_manager.AwaitCompilation(pipeline);
-    delete vertex_shader;
-    delete fragment_shader;
-    
     render::staging_manager.AwaitUploadCompletion();
+    // Timed Frames Must Not Include Frames Skipped While The Pipeline Compiles
+    if(replay){
+        render::pipeline_manager.AwaitCompilation(pipeline);
+    }
         
     uint8_t current_frame = 0;
     
     auto  start = std::chrono::high_resolution_clock::now();
     bool submission_fence = true;
     
-    render::CommandBuffer* command_buffer[2];
-    while(running){
+    render::CommandBuffer* command_buffer[2] = {};
+    // CPU Time From The Start Of The Frame Last Submitted With Each Fence Until Its Submit,
+    // Sampled Once That Fence Signals
+    float slot_frame_milliseconds[2] = {};
+    render::DrawQueue draw_queue[2];
+    uint32_t frame_count = 0;
+    while(running && frame_count < frame_limit){
+        PROFILE_ZONE("Frame");
         
         auto finish = std::chrono::high_resolution_clock::now();
         float delta_time = std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() / 1000000.0f;
-        std::cout << "Frame Time: "
-        << delta_time
-        << " seconds\n";
+        if(!replay){
+            std::cout << "Frame Time: "
+            << delta_time
+            << " seconds\n";
+        }
         start = std::chrono::high_resolution_clock::now();
         
+        static core::MetricHistogram* frame_time_histogram  = core::metrics.Histogram("frame_time_us");
+        static core::MetricGauge*     fragmentation_gauge   = core::metrics.Gauge("gpu_buffer_fragmentation");
+        static core::MetricGauge*     free_bytes_gauge      = core::metrics.Gauge("gpu_buffer_free_bytes");
+        frame_time_histogram->Record((uint64_t)(delta_time * 1000000.0f));
+        fragmentation_gauge->Set(render::gpu_buffer.Fragmentation());
+        free_bytes_gauge->Set((double)render::gpu_buffer.FreeBytes());
+        core::metrics.EndFrame(frame_count);
+        
 
         Input::Flush();
-        HandleEvent();
-        UpdateCamera(delta_time);
+        if(!headless){
+            HandleEvent();
+        }
+        if(replay){
+            camera_path.Apply(frame_count, &camera);
+        }
+        else{
+            UpdateCamera(delta_time);
+        }
+        if(record_camera_path_file != nullptr){
+            camera_path.Record(camera);
+        }
         
         if(Input::GetKey(ScanCode::P)){
             running = false;
         }
+        // Dumps Everything Captured So Far Without Stopping The Capture, Once Per Press Of T
+        static bool trace_key_down = false;
+        const bool trace_key_pressed = Input::GetKey(ScanCode::T) != INPUT_STATE_UP && !trace_key_down;
+        trace_key_down = Input::GetKey(ScanCode::T) != INPUT_STATE_UP;
+        if(profile_trace_file != nullptr && trace_key_pressed){
+            core::profiler.WriteChromeTrace(profile_trace_file);
+        }
+        
+        // Frames Are Drawn Without The Pipeline Until Its Compilation Finishes On The Threadpool
+        if(vertex_shader != nullptr && render::pipeline_manager.IsReady(pipeline)){
+            std::cout << "Pipeline Compile Time: "
+            << pipeline->compile_milliseconds
+            << " ms (" << (render::pipeline_manager.pipeline_cache_warm ? "warm" : "cold") << " cache)\n";
+            delete vertex_shader;
+            delete fragment_shader;
+            vertex_shader   = nullptr;
+            fragment_shader = nullptr;
+        }
         
         render::command_manager.WaitForFence(&fence[current_frame]);
+        render::gpu_profiler.BeginFrame(current_frame);
+        render::memory_budget.BeginFrame(frame_count);
+        // Record, Submit And GPU Times Belong To The Frame That Last Used This Fence
+        if(replay && command_buffer[current_frame] != nullptr){
+            frame_statistics.AddFrame(slot_frame_milliseconds[current_frame],
+                                      command_buffer[current_frame]->record_milliseconds,
+                                      command_buffer[current_frame]->submit_milliseconds,
+                                      render::gpu_profiler.timings);
+        }
+        render::descriptor_allocator.ResetFrame(current_frame, fence[current_frame].vk_fence);
+        render::bindless_table.Recycle(current_frame);
+        // Barriers Recorded Since The Last Reset, Exported With The Next Metrics Frame
+        static core::MetricGauge* barrier_gauge        = core::metrics.Gauge("barriers_per_frame");
+        static core::MetricGauge* barrier_batch_gauge  = core::metrics.Gauge("barrier_batches_per_frame");
+        static core::MetricGauge* elided_barrier_gauge = core::metrics.Gauge("elided_barriers_per_frame");
+        barrier_gauge->Set((double)render::resource_barrier_statistics.barrier_count.load());
+        barrier_batch_gauge->Set((double)render::resource_barrier_statistics.barrier_batch_count.load());
+        elided_barrier_gauge->Set((double)render::resource_barrier_statistics.elided_barrier_count.load());
+        render::resource_barrier_statistics.Reset();
         render::command_manager.ResetFence(&fence[current_frame]);
         render::command_manager.Free(command_buffer[current_frame]);
-
         
-        /*render::descriptor_allocator.Flush();
-        auto descriptor_set = render::descriptor_allocator.Allocate(set_layout);
-        auto a = render::descriptor_allocator.Allocate(set_layout);
-        auto b = render::descriptor_allocator.Allocate(set_layout);
-        auto c = render::descriptor_allocator.Allocate(set_layout);
-        auto d = render::descriptor_allocator.Allocate(set_layout);*/
+        // The Resident Image Changes As Mips Stream In And Out, So The Material Set Comes From The Frame Pool
+        render::DescriptorSet frame_descriptor_set = descriptor_set;
+        if(streaming_texture != nullptr){
+            const float distance    = glm::max(glm::length(camera.position), camera.z_near);
+            const float screen_size = swapchain->extent_.height * 2.0f /
+                                      (distance * tanf(glm::radians(camera.view_size) * 0.5f));
+            render::texture_streamer.Request(streaming_texture,
+                                             render::TextureStreamer::MipForScreenSize(streaming_texture, screen_size));
+            render::texture_streamer.Update(frame_count);
+            
+            frame_descriptor_set = render::descriptor_allocator.Allocate(set_layout, current_frame);
+            const render::DescriptorData frame_descriptor_data[] = {
+                sampler.GetDescriptorData(),
+                streaming_texture->texture.GetDescriptorData(),
+            };
+            render::descriptor_update_template_cache.Get(set_layout)->Update(frame_descriptor_set.vk_descriptor_set,
+                                                                             frame_descriptor_data);
+        }
+        if(streaming_mesh != nullptr){
+            render::mesh_streamer.RequestByDistance(camera.position);
+            render::mesh_streamer.Update(frame_count);
+        }
+        render::gpu_buffer_defragmenter.Update(frame_count);
+        // Streamers And The Defragmenter Record Into The Open Staging Batch, Which Goes Out Once Per Frame
+        render::staging_manager.SubmitUpload({});
 	        
-        render::command_manager.WaitForFence(&image_fence[current_frame]);
-        render::command_manager.ResetFence(&image_fence[current_frame]);
-        image_fence[current_frame].submission_flag = true;
-        uint32_t image_index = swapchain->AcquireImage(swapchain_semaphore[current_frame].vk_semaphore,
-                                                       image_fence[current_frame].vk_fence);
+        // Offscreen Images Cycle With The Frames In Flight, So The Frame Fence Already Guards Reuse
+        uint32_t image_index;
+        if(headless){
+            image_index = swapchain->AcquireImage(VK_NULL_HANDLE, VK_NULL_HANDLE);
+        }
+        else{
+            render::command_manager.WaitForFence(&image_fence[current_frame]);
+            render::command_manager.ResetFence(&image_fence[current_frame]);
+            image_fence[current_frame].submission_flag = true;
+            image_index = swapchain->AcquireImage(swapchain_semaphore[current_frame].vk_semaphore,
+                                                  image_fence[current_frame].vk_fence);
+        }
         
         float aspect_ratio = (float)window.width / (float)window.height;
         glm::mat4 view_projection(camera.GetViewProjection(aspect_ratio));
         
+        PROFILE_ZONE("Build And Submit Frame");
+        render::DrawQueue* frame_draw_queue = &draw_queue[current_frame];
+        frame_draw_queue->Clear();
+        
+        render::DrawKey draw_key{};
+        draw_key.pipeline = pipeline->sort_id;
+        draw_key.depth    = render::QuantizeDepth(glm::length(camera.position), camera.z_near, camera.z_far);
+        if(streaming_mesh == nullptr){
+            frame_draw_queue->Submit(draw_key, mesh.CreateDrawPacket(pipeline, frame_descriptor_set, 1, 0));
+        }
+        else if(render::mesh_streamer.Request(streaming_mesh)){
+            frame_draw_queue->Submit(draw_key, render::mesh_streamer.CreateDrawPacket(streaming_mesh, pipeline,
+                                                                                     frame_descriptor_set, 1, 0));
+        }
+        frame_draw_queue->Sort();
+        
+        // Frames Are Recorded One At A Time On The Record Thread, So The Graph's Per Frame State Is Only Touched There
         command_buffer[current_frame] =
-        render::command_manager.RecordAsync([render_buffer, swapchain, image_index, pipeline,
-                                             view_projection, descriptor_set, &mesh]
+        render::command_manager.RecordAsync([&frame_graph, &forward_pass_data, swapchain, swapchain_image,
+                                             image_index, view_projection, frame_draw_queue]
                                              (VkCommandBuffer vk_command_buffer){
-            render_buffer->Begin(vk_command_buffer, swapchain, image_index);
-            pipeline->Bind(vk_command_buffer);
-            
-            render::gpu_buffer.buffer.BindAsVertexBuffer(vk_command_buffer, 0);
-            render::gpu_buffer.buffer.BindAsIndexBuffer (vk_command_buffer, 0);
-            
-            pipeline->PushConstant(vk_command_buffer, 0, sizeof(glm::mat4), (void*)&view_projection);
-            pipeline->BindDescriptorSet(vk_command_buffer, descriptor_set, 0);
-            
-            VkViewport viewport{};
-            viewport.width  = swapchain->extent_.width;
-            viewport.height = swapchain->extent_.height;
-            viewport.x = 0;
-            viewport.y = 0;
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-            vkCmdSetViewport(vk_command_buffer, 0, 1, &viewport);
-            
-            VkRect2D scissor{};
-            scissor.offset = {0, 0};
-            scissor.extent = swapchain->extent_;
-            vkCmdSetScissor(vk_command_buffer, 0, 1, &scissor);
-            
-            mesh.Draw(vk_command_buffer, 1, 0);
-            
-            vkCmdEndRenderPass(vk_command_buffer);
+            forward_pass_data = { image_index, view_projection, frame_draw_queue };
+            frame_graph.SetImportedImage(swapchain_image, swapchain->images_[image_index],
+                                         swapchain->GetImageViews()[image_index]);
+            frame_graph.Execute(vk_command_buffer);
         });
         
         render::command_manager.SignalRecordCompletion(command_buffer[current_frame]);
         
         render::SubmitInfo submit_info{};
         submit_info.fence             = &fence[current_frame];
-        submit_info.wait_semaphores   = {swapchain_semaphore[current_frame]};
-        submit_info.signal_semaphores = {render_finished_semaphore[current_frame]};
         submit_info.wait_stage_flags  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        if(!headless){
+            submit_info.wait_semaphores   = {swapchain_semaphore[current_frame]};
+            submit_info.signal_semaphores = {render_finished_semaphore[current_frame]};
+        }
 
         render::command_manager.SubmitAsync(submit_info, command_buffer[current_frame]);
+        auto submitted = std::chrono::high_resolution_clock::now();
+        slot_frame_milliseconds[current_frame] =
+        std::chrono::duration_cast<std::chrono::microseconds>(submitted - start).count() / 1000.0f;
         
-        render::PresentInfo present_info{};
-        present_info.wait_semaphores = {render_finished_semaphore[current_frame]};
-        present_info.swapchains      = {swapchain};
-        present_info.image_indices   = {image_index};
-        
-        render::command_manager.PresentAsync(present_info);
+        if(!headless){
+            render::PresentInfo present_info{};
+            present_info.wait_semaphores = {render_finished_semaphore[current_frame]};
+            present_info.swapchains      = {swapchain};
+            present_info.image_indices   = {image_index};
+            
+            render::command_manager.PresentAsync(present_info);
+        }
         
         current_frame = (current_frame + 1) % 2;
+        frame_count++;
     }
     
     render::command_manager.WaitForFence(&fence[current_frame]);
     render::command_manager.WaitForFence(&fence[(current_frame + 1) % 2]);
+    
+    if(replay){
+        // Frames Still In Flight When The Loop Ended, Oldest First
+        for(uint32_t i = 0; i < 2; i++){
+            const uint8_t slot = (current_frame + i) % 2;
+            if(command_buffer[slot] == nullptr){
+                continue;
+            }
+            render::gpu_profiler.BeginFrame(slot);
+            frame_statistics.AddFrame(slot_frame_milliseconds[slot],
+                                      command_buffer[slot]->record_milliseconds,
+                                      command_buffer[slot]->submit_milliseconds,
+                                      render::gpu_profiler.timings);
+        }
+        if(benchmark_output_file != nullptr){
+            frame_statistics.WriteJson("replay", benchmark_output_file);
+        }
+        else{
+            std::cout << frame_statistics.ToJson("replay");
+        }
+    }
+    if(record_camera_path_file != nullptr){
+        camera_path.Save(record_camera_path_file);
+    }
+    if(profile_trace_file != nullptr){
+        core::profiler.WriteChromeTrace(profile_trace_file);
+    }
+    core::metrics.Terminate();
     fence[0].Terminate();
     fence[1].Terminate();
 
@@ -313,24 +828,45 @@ int main(int argc, char** argv){
     render_finished_semaphore[0].Terminate();
     render_finished_semaphore[1].Terminate();
 
+    if(stream_meshes){
+        render::mesh_streamer.Terminate();
+    }
+    render::gpu_buffer_defragmenter.Terminate();
     render::gpu_buffer.Terminate();
     render::pipeline_manager.Destroy(pipeline);
-    set_layout.Terminate();
+    delete vertex_shader;
+    delete fragment_shader;
 
-    texture.Terminate();
+    if(stream_textures){
+        render::texture_streamer.Terminate();
+    }
+    else{
+        texture.Terminate();
+    }
     sampler.Terminate();
     
+    frame_graph.Terminate();
     render::staging_manager.Terminate();
     render::command_manager.Terminate();
+    render::gpu_profiler.Terminate();
+    render::memory_budget.Terminate();
     render::pipeline_manager.Terminate();
+    render::shader_compiler.Terminate();
+    render::bindless_table.Terminate();
     render::descriptor_allocator.Terminate();
+    render::image_view_cache.Terminate();
+    render::sampler_cache.Terminate();
+    render::descriptor_update_template_cache.Terminate();
+    render::descriptor_set_layout_cache.Terminate();
     
     delete render_buffer;
     delete swapchain;
 
     render::context.Terminate();
     
-    window.Terminate();
+    if(!headless){
+        window.Terminate();
+    }
     
     core::threadpool.Terminate();
 }
@@ -0,0 +1,162 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace core{
+MetricsRegistry metrics{};
+
+void MetricHistogram::Record(uint64_t value){
+    uint32_t bucket = 0;
+    while(bucket + 1 < BUCKET_COUNT && (value >> bucket) > 1){
+        bucket++;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t previous_max = max.load(std::memory_order_relaxed);
+    while(value > previous_max && !max.compare_exchange_weak(previous_max, value, std::memory_order_relaxed)){}
+}
+
+struct HistogramSnapshot{
+    uint64_t count;
+    double   mean;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+};
+// Percentiles Report The Upper Bound Of The Bucket They Fall In
+static HistogramSnapshot TakeSnapshot(MetricHistogram* histogram){
+    uint64_t buckets[MetricHistogram::BUCKET_COUNT];
+    for(uint32_t i = 0; i < MetricHistogram::BUCKET_COUNT; i++){
+        buckets[i] = histogram->buckets[i].exchange(0, std::memory_order_relaxed);
+    }
+    HistogramSnapshot snapshot{};
+    snapshot.count = histogram->count.exchange(0, std::memory_order_relaxed);
+    uint64_t sum   = histogram->sum.exchange(0, std::memory_order_relaxed);
+    snapshot.max   = histogram->max.exchange(0, std::memory_order_relaxed);
+    snapshot.mean  = snapshot.count != 0 ? (double)sum / snapshot.count : 0.0;
+    
+    auto percentile = [&](double p){
+        uint64_t target = (uint64_t)(p * snapshot.count + 0.5);
+        uint64_t seen = 0;
+        for(uint32_t i = 0; i < MetricHistogram::BUCKET_COUNT; i++){
+            seen += buckets[i];
+            if(seen >= target && seen != 0){
+                return std::min<uint64_t>(i + 1 < 64 ? (2ull << i) - 1 : UINT64_MAX, snapshot.max);
+            }
+        }
+        return snapshot.max;
+    };
+    snapshot.p50 = percentile(0.50);
+    snapshot.p99 = percentile(0.99);
+    return snapshot;
+}
+
+void MetricsRegistry::Initialize(const char* filepath, MetricsFormat format){
+    format_ = format;
+    if(filepath != nullptr){
+        file_.open(filepath);
+        if(!file_.is_open()){
+            throw std::runtime_error("FAILED TO OPEN METRICS FILE");
+        }
+    }
+}
+void MetricsRegistry::Terminate(){
+    if(file_.is_open()){
+        file_.close();
+    }
+}
+
+MetricCounter* MetricsRegistry::Counter(const char* name){
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    for(auto& [counter_name, counter] : counters_){
+        if(counter_name == name){
+            return &counter;
+        }
+    }
+    counters_.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+    return &counters_.back().second;
+}
+MetricGauge* MetricsRegistry::Gauge(const char* name){
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    for(auto& [gauge_name, gauge] : gauges_){
+        if(gauge_name == name){
+            return &gauge;
+        }
+    }
+    gauges_.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+    return &gauges_.back().second;
+}
+MetricHistogram* MetricsRegistry::Histogram(const char* name){
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    for(auto& [histogram_name, histogram] : histograms_){
+        if(histogram_name == name){
+            return &histogram;
+        }
+    }
+    histograms_.emplace_back(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple());
+    return &histograms_.back().second;
+}
+
+void MetricsRegistry::WriteCsvHeader(){
+    csv_metric_count_ = counters_.size() + gauges_.size() + histograms_.size();
+    file_ << "frame";
+    for(auto& [name, counter] : counters_){
+        file_ << "," << name;
+    }
+    for(auto& [name, gauge] : gauges_){
+        file_ << "," << name;
+    }
+    for(auto& [name, histogram] : histograms_){
+        file_ << "," << name << "_count," << name << "_mean," << name << "_p50," << name << "_p99," << name << "_max";
+    }
+    file_ << "\n";
+}
+
+void MetricsRegistry::EndFrame(uint64_t frame){
+    if(!file_.is_open()){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    if(format_ == METRICS_FORMAT_CSV){
+        if(csv_metric_count_ != counters_.size() + gauges_.size() + histograms_.size()){
+            WriteCsvHeader();
+        }
+        file_ << frame;
+        for(auto& [name, counter] : counters_){
+            uint64_t value = counter.value.load(std::memory_order_relaxed);
+            file_ << "," << value - counter.exported_value;
+            counter.exported_value = value;
+        }
+        for(auto& [name, gauge] : gauges_){
+            file_ << "," << gauge.value.load(std::memory_order_relaxed);
+        }
+        for(auto& [name, histogram] : histograms_){
+            HistogramSnapshot snapshot = TakeSnapshot(&histogram);
+            file_ << "," << snapshot.count << "," << snapshot.mean << "," << snapshot.p50
+                  << "," << snapshot.p99 << "," << snapshot.max;
+        }
+        file_ << "\n";
+        return;
+    }
+    
+    // One JSON Object Per Line
+    file_ << "{\"frame\":" << frame;
+    for(auto& [name, counter] : counters_){
+        uint64_t value = counter.value.load(std::memory_order_relaxed);
+        file_ << ",\"" << name << "\":" << value - counter.exported_value;
+        counter.exported_value = value;
+    }
+    for(auto& [name, gauge] : gauges_){
+        file_ << ",\"" << name << "\":" << gauge.value.load(std::memory_order_relaxed);
+    }
+    for(auto& [name, histogram] : histograms_){
+        HistogramSnapshot snapshot = TakeSnapshot(&histogram);
+        file_ << ",\"" << name << "\":{\"count\":" << snapshot.count << ",\"mean\":" << snapshot.mean
+              << ",\"p50\":" << snapshot.p50 << ",\"p99\":" << snapshot.p99 << ",\"max\":" << snapshot.max << "}";
+    }
+    file_ << "}\n";
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace core{
+// Monotonic, Exported As The Increase Since The Previous Frame
+struct MetricCounter{
+    void Add(uint64_t count = 1){ value.fetch_add(count, std::memory_order_relaxed); }
+    
+    std::atomic<uint64_t> value = 0;
+    uint64_t exported_value = 0;
+};
+// Last Written Value, Exported As Is
+struct MetricGauge{
+    void Set(double value){ this->value.store(value, std::memory_order_relaxed); }
+    
+    std::atomic<double> value = 0.0;
+};
+// Power Of Two Buckets, Emptied Every Exported Frame
+struct MetricHistogram{
+    static const uint32_t BUCKET_COUNT = 64;
+    void Record(uint64_t value);
+    
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum   = 0;
+    std::atomic<uint64_t> max   = 0;
+};
+
+enum MetricsFormat{
+    METRICS_FORMAT_CSV,
+    METRICS_FORMAT_JSON,
+};
+
+// Metrics Are Looked Up Once By Name And Updated Lock Free; The Returned Pointers Stay Valid Until Terminate
+class MetricsRegistry{
+public:
+    // A Null Filepath Keeps Collecting Without Exporting
+    void Initialize(const char* filepath, MetricsFormat format);
+    void Terminate();
+    
+    MetricCounter*   Counter  (const char* name);
+    MetricGauge*     Gauge    (const char* name);
+    MetricHistogram* Histogram(const char* name);
+    
+    void EndFrame(uint64_t frame);
+    
+private:
+    void WriteCsvHeader();
+    
+    std::mutex metric_mutex_{};
+    std::deque<std::pair<std::string, MetricCounter>>   counters_{};
+    std::deque<std::pair<std::string, MetricGauge>>     gauges_{};
+    std::deque<std::pair<std::string, MetricHistogram>> histograms_{};
+    
+    std::ofstream file_{};
+    MetricsFormat format_ = METRICS_FORMAT_CSV;
+    // Metrics Are Registered Lazily On First Use, So The CSV Header Is Repeated Whenever New Columns Appear
+    size_t csv_metric_count_ = 0;
+};
+extern MetricsRegistry metrics;
+}
@@ -0,0 +1,123 @@
+#include "profiler.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace core{
+Profiler profiler{};
+thread_local ProfileThreadBuffer* Profiler::thread_buffer_ = nullptr;
+
+void Profiler::Initialize(uint32_t events_per_thread){
+    events_per_thread_ = events_per_thread;
+    start_ = std::chrono::steady_clock::now();
+    enabled_ = true;
+}
+// Threads Still Holding A Buffer Pointer Must Have Stopped Recording
+void Profiler::Terminate(){
+    enabled_ = false;
+}
+
+ProfileThreadBuffer* Profiler::CreateBuffer(){
+    auto buffer = std::make_unique<ProfileThreadBuffer>();
+    buffer->thread_index = (uint32_t)thread_buffers_.size();
+    buffer->name     = "thread " + std::to_string(buffer->thread_index);
+    buffer->capacity = events_per_thread_;
+    buffer->events   = std::make_unique<ProfileEvent[]>(events_per_thread_);
+    thread_buffers_.emplace_back(std::move(buffer));
+    return thread_buffers_.back().get();
+}
+ProfileThreadBuffer* Profiler::RegisterThread(){
+    std::lock_guard<std::mutex> lock(thread_buffer_mutex_);
+    thread_buffer_ = CreateBuffer();
+    return thread_buffer_;
+}
+ProfileThreadBuffer* Profiler::RegisterTrack(const char* name){
+    std::lock_guard<std::mutex> lock(thread_buffer_mutex_);
+    ProfileThreadBuffer* buffer = CreateBuffer();
+    buffer->name = name;
+    return buffer;
+}
+void Profiler::SetThreadName(const char* name){
+    if(!IsEnabled()){
+        return;
+    }
+    ProfileThreadBuffer* buffer = thread_buffer_ != nullptr ? thread_buffer_ : RegisterThread();
+    std::lock_guard<std::mutex> lock(thread_buffer_mutex_);
+    buffer->name = name;
+}
+
+float Profiler::MeasureZoneOverhead(uint32_t iterations){
+    if(!IsEnabled() || iterations == 0){
+        return 0.0f;
+    }
+    // The Calibration Zones Go To A Scratch Ring So They Neither Appear In Nor Overwrite The Trace
+    ProfileThreadBuffer scratch{};
+    scratch.capacity = 1024;
+    scratch.events   = std::make_unique<ProfileEvent[]>(scratch.capacity);
+    ProfileThreadBuffer* buffer = thread_buffer_;
+    thread_buffer_ = &scratch;
+    
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; i++){
+        ProfileZone zone("Profiler Overhead");
+    }
+    auto finish = std::chrono::steady_clock::now();
+    
+    thread_buffer_ = buffer;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count() / (float)iterations;
+}
+
+static void WriteEscaped(std::ofstream& file, const std::string& text){
+    for(char c : text){
+        if(c == '"' || c == '\\'){
+            file << '\\';
+        }
+        file << c;
+    }
+}
+// Chrome Trace Event Format, Opened By chrome://tracing And Perfetto
+void Profiler::WriteChromeTrace(const char* filepath){
+    std::ofstream file(filepath);
+    if(!file.is_open()){
+        throw std::runtime_error("FAILED TO WRITE PROFILER TRACE");
+    }
+    std::lock_guard<std::mutex> lock(thread_buffer_mutex_);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    uint64_t overwritten_count = 0;
+    std::vector<ProfileEvent> events{};
+    for(const std::unique_ptr<ProfileThreadBuffer>& buffer : thread_buffers_){
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+             << buffer->thread_index << ",\"args\":{\"name\":\"";
+        WriteEscaped(file, buffer->name);
+        file << "\"}}";
+        first = false;
+        
+        // The Owning Thread Keeps Recording, Events It May Have Overwritten During The Copy Are Skipped
+        const uint64_t count = buffer->count.load(std::memory_order_acquire);
+        const uint64_t first_index = count > buffer->capacity ? count - buffer->capacity : 0;
+        events.clear();
+        for(uint64_t i = first_index; i < count; i++){
+            events.emplace_back(buffer->events[i % buffer->capacity]);
+        }
+        const uint64_t count_after = buffer->count.load(std::memory_order_acquire);
+        const uint64_t valid_index = std::max(first_index, count_after + 1 > buffer->capacity ?
+                                                           count_after + 1 - buffer->capacity : 0);
+        overwritten_count += valid_index;
+        for(uint64_t i = valid_index; i < count; i++){
+            const ProfileEvent& event = events[i - first_index];
+            file << ",\n{\"name\":\"";
+            WriteEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_index
+                 << ",\"ts\":"  << event.start_nanoseconds / 1000 << "." << event.start_nanoseconds % 1000 / 100
+                 << ",\"dur\":" << event.duration_nanoseconds / 1000 << "." << event.duration_nanoseconds % 1000 / 100
+                 << "}";
+        }
+    }
+    file << "\n]}\n";
+    static MetricGauge* overwritten_gauge = metrics.Gauge("profiler_overwritten_events");
+    overwritten_gauge->Set((double)overwritten_count);
+}
+}
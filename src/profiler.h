@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace core{
+struct ProfileEvent{
+    const char* name;
+    uint64_t start_nanoseconds;
+    uint64_t duration_nanoseconds;
+};
+// Ring Of The Most Recent capacity Events, Written Only By Its Owning Thread;
+// count Is The Total Ever Recorded, Readers See Events Below The Released Count
+struct ProfileThreadBuffer{
+    std::string name;
+    uint32_t    thread_index;
+    std::unique_ptr<ProfileEvent[]> events;
+    uint32_t    capacity = 0;
+    std::atomic<uint64_t> count = 0;
+};
+
+class Profiler{
+public:
+    void Initialize(uint32_t events_per_thread = 1 << 18);
+    void Terminate();
+    
+    bool IsEnabled(){ return enabled_.load(std::memory_order_relaxed); }
+    void SetThreadName(const char* name);
+    
+    uint64_t Now(){
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+    void Record(const char* name, uint64_t start_nanoseconds, uint64_t duration_nanoseconds){
+        Record(thread_buffer_ != nullptr ? thread_buffer_ : RegisterThread(),
+               name, start_nanoseconds, duration_nanoseconds);
+    }
+    // Tracks Hold Events Not Measured On A CPU Thread, Such As Resolved GPU Timestamps;
+    // Each Track Must Still Only Be Written From One Thread At A Time
+    ProfileThreadBuffer* RegisterTrack(const char* name);
+    void Record(ProfileThreadBuffer* buffer, const char* name, uint64_t start_nanoseconds, uint64_t duration_nanoseconds){
+        uint64_t index = buffer->count.load(std::memory_order_relaxed);
+        buffer->events[index % buffer->capacity] = { name, start_nanoseconds, duration_nanoseconds };
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+    
+    // Average Cost Of One Enabled Zone, Measured On The Calling Thread
+    float MeasureZoneOverhead(uint32_t iterations);
+    // Writes The Events Still Held By Each Ring, Older Ones Were Overwritten And Are Counted
+    // In The profiler_overwritten_events Gauge
+    void  WriteChromeTrace(const char* filepath);
+    
+private:
+    ProfileThreadBuffer* RegisterThread();
+    ProfileThreadBuffer* CreateBuffer();
+    
+    std::atomic<bool> enabled_ = false;
+    uint32_t events_per_thread_ = 0;
+    std::chrono::steady_clock::time_point start_{};
+    
+    std::mutex thread_buffer_mutex_{};
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> thread_buffers_{};
+    static thread_local ProfileThreadBuffer* thread_buffer_;
+};
+extern Profiler profiler;
+
+class ProfileZone{
+public:
+    ProfileZone(const char* name) : name_(name){
+        if(profiler.IsEnabled()){
+            start_nanoseconds_ = profiler.Now();
+        }
+    }
+    ~ProfileZone(){
+        if(start_nanoseconds_ != UINT64_MAX){
+            profiler.Record(name_, start_nanoseconds_, profiler.Now() - start_nanoseconds_);
+        }
+    }
+private:
+    const char* name_;
+    uint64_t start_nanoseconds_ = UINT64_MAX;
+};
+}
+
+#define PROFILE_CONCATENATE_(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_(a, b)
+
+// Zone Names Must Be String Literals Or Otherwise Outlive The Profiler
+#ifndef ENGINE_DISABLE_PROFILING
+#define PROFILE_ZONE(name) core::ProfileZone PROFILE_CONCATENATE(profile_zone_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_THREAD(name) core::profiler.SetThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD(name)
+#endif
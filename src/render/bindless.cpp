@@ -0,0 +1,167 @@
+#include "render/bindless.h"
+
+namespace render{
+BindlessTable bindless_table{};
+void BindlessTable::Initialize(uint32_t frame_count, uint32_t capacity){
+    if(!render::context.descriptor_indexing_supported){
+        return;
+    }
+    this->frame_count = frame_count;
+    this->capacity    = std::min(capacity, render::context.max_update_after_bind_sampled_images);
+    retired_slots.resize(frame_count);
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[BINDLESS_BINDING_SAMPLER].binding         = BINDLESS_BINDING_SAMPLER;
+    bindings[BINDLESS_BINDING_SAMPLER].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[BINDLESS_BINDING_SAMPLER].descriptorCount = 1;
+    bindings[BINDLESS_BINDING_SAMPLER].stageFlags      = VK_SHADER_STAGE_ALL;
+    bindings[BINDLESS_BINDING_TEXTURE].binding         = BINDLESS_BINDING_TEXTURE;
+    bindings[BINDLESS_BINDING_TEXTURE].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[BINDLESS_BINDING_TEXTURE].descriptorCount = this->capacity;
+    bindings[BINDLESS_BINDING_TEXTURE].stageFlags      = VK_SHADER_STAGE_ALL;
+
+    const VkDescriptorBindingFlagsEXT binding_flags[2] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+    };
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_info{};
+    binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    binding_flags_info.pNext = nullptr;
+    binding_flags_info.bindingCount  = 2;
+    binding_flags_info.pBindingFlags = binding_flags;
+
+    VkDescriptorSetLayoutCreateInfo layout_create_info{};
+    layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_create_info.pNext = &binding_flags_info;
+    layout_create_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layout_create_info.bindingCount = 2;
+    layout_create_info.pBindings    = bindings;
+    VkResult vk_result = vkCreateDescriptorSetLayout(render::context.vk_device, &layout_create_info, nullptr,
+                                                     &set_layout.vk_descriptor_set_layout);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE BINDLESS DESCRIPTOR SET LAYOUT");
+    }
+
+    VkDescriptorPoolSize pool_sizes[2] = {
+        { VK_DESCRIPTOR_TYPE_SAMPLER,       1 },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, this->capacity },
+    };
+    VkDescriptorPoolCreateInfo pool_create_info{};
+    pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_create_info.pNext = nullptr;
+    pool_create_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    pool_create_info.maxSets = 1;
+    pool_create_info.poolSizeCount = 2;
+    pool_create_info.pPoolSizes    = pool_sizes;
+    vk_result = vkCreateDescriptorPool(render::context.vk_device, &pool_create_info, nullptr, &vk_descriptor_pool);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE BINDLESS DESCRIPTOR POOL");
+    }
+
+    VkDescriptorSetAllocateInfo allocate_info{};
+    allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocate_info.pNext = nullptr;
+    allocate_info.descriptorPool = vk_descriptor_pool;
+    allocate_info.descriptorSetCount = 1;
+    allocate_info.pSetLayouts = &set_layout.vk_descriptor_set_layout;
+    vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &vk_descriptor_set);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO ALLOCATE BINDLESS DESCRIPTOR SET");
+    }
+}
+void BindlessTable::Terminate(){
+    if(!IsEnabled()){
+        return;
+    }
+    vkDestroyDescriptorPool(render::context.vk_device, vk_descriptor_pool, nullptr);
+    set_layout.Terminate();
+    vk_descriptor_pool = VK_NULL_HANDLE;
+    vk_descriptor_set  = VK_NULL_HANDLE;
+    free_slots.clear();
+    retired_slots.clear();
+    next_slot = 0;
+}
+
+bool BindlessTable::IsEnabled(){
+    return vk_descriptor_set != VK_NULL_HANDLE;
+}
+// Reflected Runtime Arrays Have No Count, So A Sampler Plus Unsized Texture Array Selects The Table
+bool BindlessTable::Matches(const std::vector<DescriptorBinding>& bindings){
+    return IsEnabled() && bindings.size() == 2 &&
+    bindings[0].binding == BINDLESS_BINDING_SAMPLER && bindings[0].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER &&
+    bindings[1].binding == BINDLESS_BINDING_TEXTURE && bindings[1].descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE &&
+    bindings[1].descriptorCount == 0;
+}
+
+uint32_t BindlessTable::Register(VkImageView vk_view){
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex);
+        if(!free_slots.empty()){
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+        else if(next_slot < capacity){
+            index = next_slot++;
+        }
+        else{
+            throw std::runtime_error("BINDLESS TEXTURE TABLE FULL");
+        }
+    }
+
+    VkDescriptorImageInfo image_info{};
+    image_info.imageView   = vk_view;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_info.sampler     = VK_NULL_HANDLE;
+
+    VkWriteDescriptorSet set_write{};
+    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set_write.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    set_write.descriptorCount = 1;
+    set_write.dstBinding      = BINDLESS_BINDING_TEXTURE;
+    set_write.dstArrayElement = index;
+    set_write.dstSet     = vk_descriptor_set;
+    set_write.pImageInfo = &image_info;
+    vkUpdateDescriptorSets(render::context.vk_device, 1, &set_write, 0, nullptr);
+    return index;
+}
+void BindlessTable::Release(uint32_t index){
+    if(index == BINDLESS_INVALID_INDEX){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    retired_slots[current_frame].emplace_back(index);
+}
+void BindlessTable::SetSampler(VkSampler vk_sampler){
+    VkDescriptorImageInfo image_info{};
+    image_info.imageView   = VK_NULL_HANDLE;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.sampler     = vk_sampler;
+
+    VkWriteDescriptorSet set_write{};
+    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set_write.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
+    set_write.descriptorCount = 1;
+    set_write.dstBinding      = BINDLESS_BINDING_SAMPLER;
+    set_write.dstArrayElement = 0;
+    set_write.dstSet     = vk_descriptor_set;
+    set_write.pImageInfo = &image_info;
+    vkUpdateDescriptorSets(render::context.vk_device, 1, &set_write, 0, nullptr);
+}
+
+// Called Once The Frame's Fence Has Signaled, Every Frame Since Its Last Use Has Also Completed
+void BindlessTable::Recycle(uint32_t frame){
+    if(!IsEnabled()){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    current_frame = frame % frame_count;
+    std::vector<uint32_t>& retired = retired_slots[current_frame];
+    free_slots.insert(free_slots.end(), retired.begin(), retired.end());
+    retired.clear();
+}
+void BindlessTable::Bind(VkCommandBuffer vk_command_buffer, VkPipelineLayout vk_pipeline_layout, uint32_t set_index){
+    vkCmdBindDescriptorSets(vk_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline_layout,
+                            set_index, 1, &vk_descriptor_set, 0, nullptr);
+}
+}
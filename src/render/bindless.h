@@ -0,0 +1,51 @@
+#pragma once
+#include <mutex>
+#include <vector>
+
+#include "render/context.h"
+#include "render/descriptor.h"
+
+namespace render{
+constexpr uint32_t BINDLESS_INVALID_INDEX = UINT32_MAX;
+
+// Binding Layout Of The Bindless Set, Matching
+// layout(binding = 0) uniform sampler   sampler_;
+// layout(binding = 1) uniform texture2D textures[];
+enum BindlessBinding{
+    BINDLESS_BINDING_SAMPLER = 0,
+    BINDLESS_BINDING_TEXTURE = 1,
+};
+
+// One Update-After-Bind Descriptor Set Holding Every Live Texture, Bound Once Per Pipeline Layout
+// So Draws Select Textures By Index Instead Of Rebinding Descriptor Sets
+class BindlessTable{
+public:
+    void Initialize(uint32_t frame_count, uint32_t capacity = 16384);
+    void Terminate();
+
+    bool IsEnabled();
+    bool Matches(const std::vector<DescriptorBinding>& bindings);
+
+    uint32_t Register(VkImageView vk_view);
+    void     Release (uint32_t index);
+    void     SetSampler(VkSampler vk_sampler);
+
+    void Recycle(uint32_t frame);
+    void Bind(VkCommandBuffer vk_command_buffer, VkPipelineLayout vk_pipeline_layout, uint32_t set_index);
+
+    uint32_t capacity    = 0;
+    uint32_t frame_count = 0;
+
+    DescriptorSetLayout set_layout{};
+    VkDescriptorPool vk_descriptor_pool = VK_NULL_HANDLE;
+    VkDescriptorSet  vk_descriptor_set  = VK_NULL_HANDLE;
+
+    // Released Slots Wait Out The Frames That May Still Sample Them Before Reuse
+    std::mutex slot_mutex;
+    uint32_t next_slot     = 0;
+    uint32_t current_frame = 0;
+    std::vector<uint32_t> free_slots{};
+    std::vector<std::vector<uint32_t>> retired_slots{};
+};
+extern BindlessTable bindless_table;
+}
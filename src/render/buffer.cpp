@@ -1,4 +1,7 @@
 #include "buffer.h"
+#include "metrics.h"
+
+#include <algorithm>
 
 namespace render{
 Buffer::Buffer(){};
@@ -23,11 +26,21 @@ char* Buffer::Initialize(BufferInfo buffer_info){
     VmaAllocationInfo alloc_info{};
     vmaCreateBuffer(render::context.allocator, &create_info, &alloc_create_info,
                     &vk_buffer, &vma_allocation, &alloc_info);
+    category        = buffer_info.category;
+    allocation_size = alloc_info.size;
+    render::memory_budget.Track(category, allocation_size);
     
-    return (char*)alloc_info.pMappedData;
+    mapped_pointer = (char*)alloc_info.pMappedData;
+    VkMemoryPropertyFlags memory_flags;
+    vmaGetAllocationMemoryProperties(render::context.allocator, vma_allocation, &memory_flags);
+    host_coherent = memory_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    return mapped_pointer;
 }
 void Buffer::Terminate(){
+    render::memory_budget.Untrack(category, allocation_size);
+    allocation_size = 0;
     vmaDestroyBuffer(render::context.allocator, vk_buffer, vma_allocation);
+    mapped_pointer = nullptr;
     vk_buffer = VK_NULL_HANDLE;
 }
 
@@ -38,58 +51,136 @@ void Buffer::BindAsIndexBuffer(VkCommandBuffer vk_command_buffer, VkDeviceSize o
     vkCmdBindIndexBuffer(vk_command_buffer, vk_buffer, offset, VK_INDEX_TYPE_UINT32);
 }
 
-// --- Region List --- //
-RegionList::RegionList(){};
-RegionList::RegionList(size_t offset, size_t size) : list_({{offset, size}}) {}
-bool RegionList::GetRegion(size_t size, size_t alignment, Region* acquired_region){
-    size_t padding = 0;
-    for(Region& memory : list_){
-        if(alignment != 0 && memory.offset % alignment){
-            padding = alignment - (memory.offset % alignment);
-        }
-        if(memory.size < size + padding){
-            continue;
+// --- Vertex Buffer --- //
+SuballocatedBuffer gpu_buffer;
+SuballocatedBuffer:: SuballocatedBuffer(){};
+SuballocatedBuffer::~SuballocatedBuffer(){};
+
+void SuballocatedBuffer::Initialize(BufferInfo buffer_info, uint32_t max_page_count){
+    page_info = buffer_info;
+    this->max_page_count = max_page_count;
+}
+void SuballocatedBuffer::Terminate(){
+    for(std::unique_ptr<BufferPage>& page : pages){
+        if(page != nullptr){
+            page->buffer.Terminate();
         }
-        *acquired_region = Region{ memory.offset, size + padding };
-        memory.size   -= size + padding;
-        memory.offset += size + padding;
-        return true;
     }
-    return false;
+    pages.clear();
+    relocatables.clear();
+    free_handles.clear();
 }
-void RegionList::FreeRegion(Region free_memory){
-    size_t index = list_.size() / 2;
-    while(index / 2 != 0){
-        if     (free_memory.offset < list_[index].offset){ index -= index / 2;}
-        else if(free_memory.offset > list_[index].offset){ index += index / 2; }
+
+bool SuballocatedBuffer::TryAllocate(size_t size, size_t alignment, Region* region, bool allow_new_page){
+    for(uint32_t page = 0; page < pages.size(); page++){
+        if(pages[page] != nullptr && pages[page]->region_list.GetRegion(size, alignment, region)){
+            region->page = page;
+            return true;
+        }
     }
-    if(free_memory.offset > list_[index].offset){ index++; }
-    
-    if(free_memory.offset + free_memory.size == list_[index].offset){
-        list_[index].offset = free_memory.offset;
-        list_[index].size += free_memory.size;
-        
-        if(index - 1 != UINT32_MAX && list_[index - 1].offset + list_[index - 1].size == free_memory.offset){
-            list_[index - 1].size += list_[index].size;
-            list_.erase(list_.begin() + index);
-        } return;
+    if(!allow_new_page){
+        return false;
+    }
+    uint32_t page = 0;
+    while(page < pages.size() && pages[page] != nullptr){
+        page++;
     }
-    else if(list_[index].offset + list_[index].size == free_memory.offset){
-        list_[index].size += free_memory.size; return;
+    if(page >= max_page_count){
+        return false;
     }
-    list_.insert(list_.begin() + index, free_memory);
+    if(page == pages.size()){
+        pages.emplace_back();
+    }
+    BufferInfo info = page_info;
+    info.size = std::max(page_info.size, size);
+    pages[page] = std::make_unique<BufferPage>();
+    pages[page]->buffer.Initialize(info);
+    pages[page]->region_list = RegionList(0, info.size);
+    pages[page]->size = info.size;
+    
+    static core::MetricGauge* page_gauge = core::metrics.Gauge("gpu_buffer_page_count");
+    page_gauge->Set((double)PageCount());
+    
+    pages[page]->region_list.GetRegion(size, alignment, region);
+    region->page = page;
+    return true;
+}
+void SuballocatedBuffer::Free(Region region){
+    pages[region.page]->region_list.FreeRegion(region);
 }
 
-// --- Vertex Buffer --- //
-SuballocatedBuffer gpu_buffer;
-SuballocatedBuffer:: SuballocatedBuffer(){};
-SuballocatedBuffer::~SuballocatedBuffer(){};
+Buffer* SuballocatedBuffer::GetBuffer(uint32_t page){
+    return &pages[page]->buffer;
+}
+uint32_t SuballocatedBuffer::PageCount(){
+    uint32_t page_count = 0;
+    for(const std::unique_ptr<BufferPage>& page : pages){
+        page_count += page != nullptr;
+    }
+    return page_count;
+}
+// Callers Ensure No Batch Or Frame In Flight Still References A Released Page
+uint32_t SuballocatedBuffer::ReleaseEmptyPages(){
+    uint32_t released_count = 0;
+    for(uint32_t page = 1; page < pages.size(); page++){
+        if(pages[page] != nullptr && pages[page]->region_list.FreeBytes() == pages[page]->size){
+            pages[page]->buffer.Terminate();
+            pages[page] = nullptr;
+            released_count++;
+        }
+    }
+    if(released_count != 0){
+        static core::MetricGauge* page_gauge = core::metrics.Gauge("gpu_buffer_page_count");
+        page_gauge->Set((double)PageCount());
+    }
+    return released_count;
+}
+size_t SuballocatedBuffer::FreeBytes(){
+    size_t free_bytes = 0;
+    for(const std::unique_ptr<BufferPage>& page : pages){
+        free_bytes += page != nullptr ? page->region_list.FreeBytes() : 0;
+    }
+    return free_bytes;
+}
+size_t SuballocatedBuffer::LargestFreeRegion(){
+    size_t largest = 0;
+    for(const std::unique_ptr<BufferPage>& page : pages){
+        largest = std::max(largest, page != nullptr ? page->region_list.LargestFreeRegion() : 0);
+    }
+    return largest;
+}
+float SuballocatedBuffer::Fragmentation(){
+    size_t free_bytes = FreeBytes();
+    return free_bytes == 0 ? 0.0f : 1.0f - (float)LargestFreeRegion() / (float)free_bytes;
+}
 
-void SuballocatedBuffer::Initialize(BufferInfo buffer_info){
-    buffer.Initialize(buffer_info);
-    region_list = RegionList(0, buffer_info.size);
+RelocationHandle SuballocatedBuffer::Track(Region region, size_t alignment){
+    RelocationHandle handle;
+    if(!free_handles.empty()){
+        handle = free_handles.back();
+        free_handles.pop_back();
+    }
+    else{
+        handle = (RelocationHandle)relocatables.size();
+        relocatables.emplace_back();
+    }
+    relocatables[handle] = Relocatable{ region, alignment, true, false };
+    return handle;
 }
-void SuballocatedBuffer::Terminate(){
-    buffer.Terminate();
+void SuballocatedBuffer::FreeTracked(RelocationHandle handle){
+    Relocatable& relocatable = relocatables[handle];
+    relocatable.live = false;
+    if(relocatable.moving){
+        return;
+    }
+    Free(relocatable.region);
+    ReleaseHandle(handle);
+}
+void SuballocatedBuffer::ReleaseHandle(RelocationHandle handle){
+    relocatables[handle] = Relocatable{};
+    free_handles.emplace_back(handle);
+}
+Region SuballocatedBuffer::Resolve(RelocationHandle handle){
+    return relocatables[handle].region;
 }
 }
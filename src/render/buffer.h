@@ -1,5 +1,10 @@
 #pragma once
 #include "render/context.h"
+#include "render/resource_state.h"
+#include "render/memory_budget.h"
+#include "render/region_list.h"
+
+#include <memory>
 
 namespace render{
 struct BufferInfo{
@@ -7,6 +12,7 @@ struct BufferInfo{
     VkBufferUsageFlags usage_flags;
     VmaMemoryUsage memory_usage;
     VmaAllocationCreateFlags create_flags;
+    MemoryCategory category = MEMORY_CATEGORY_OTHER;
 };
 class Buffer{
 public:
@@ -22,55 +28,106 @@ public:
     
     VmaAllocation vma_allocation;
     VkBuffer vk_buffer = VK_NULL_HANDLE;
+    // Set When VMA Placed The Buffer In Host Visible Memory And Mapped It
+    char* mapped_pointer = nullptr;
+    bool  host_coherent  = false;
+    ResourceState state{};
+    MemoryCategory category = MEMORY_CATEGORY_OTHER;
+    VkDeviceSize   allocation_size = 0;
 };
 
-struct Region{
-    size_t offset;
-    size_t size;
-};
-class RegionList{
-public:
-    RegionList();
-    RegionList(size_t offset, size_t size);
-    
-    bool GetRegion(size_t size, size_t alignment, Region* acquired_region);
-    void FreeRegion(Region free_memory);
-    
-private:
-    std::vector<Region> list_;
-};
-
-
 template<typename T>
 struct TBAllocation{
     uint32_t offset;
     uint32_t count;
+    uint32_t page = 0;
+};
+// Tracked Ranges May Be Moved By The Defragmenter, Owners Resolve Their Current Offset Through The Handle
+typedef uint32_t RelocationHandle;
+const RelocationHandle RELOCATION_INVALID_HANDLE = UINT32_MAX;
+struct Relocatable{
+    Region region;
+    size_t alignment;
+    bool   live   = false;
+    bool   moving = false;
 };
+// Each Page Is Its Own VkBuffer With Its Own RegionList
+struct BufferPage{
+    Buffer     buffer;
+    RegionList region_list;
+    size_t     size;
+};
+// Pages Are Created As Allocations Need Them, So Memory Is Only Committed For Loaded Content;
+// Allocations Larger Than A Page Get A Dedicated Page Of Their Own Size
 class SuballocatedBuffer{
 public:
      SuballocatedBuffer();
     ~SuballocatedBuffer();
     
-    void Initialize(BufferInfo buffer_info);
+    // buffer_info.size Is The Size Of One Page; Draw Sort Keys Hold 4 Bits Each Of Vertex And Index Page
+    void Initialize(BufferInfo buffer_info, uint32_t max_page_count = 16);
     void Terminate();
     
+    // Untyped Regions For Callers Whose Element Size Is Only Known At Runtime
+    bool TryAllocate(size_t size, size_t alignment, Region* region, bool allow_new_page = true);
+    void Free(Region region);
+    
     template<typename T>
-    TBAllocation<T> Allocate(uint32_t count){
+    bool TryAllocate(uint32_t count, TBAllocation<T>* allocation){
         Region region{};
-        region_list.GetRegion(sizeof(T) * count, sizeof(T), &region);
+        if(!TryAllocate(sizeof(T) * count, sizeof(T), &region)){
+            return false;
+        }
+        allocation->offset = (uint32_t)(region.offset / sizeof(T));
+        allocation->count  = count;
+        allocation->page   = region.page;
+        return true;
+    }
+    template<typename T>
+    TBAllocation<T> Allocate(uint32_t count){
         TBAllocation<T> allocation;
-        allocation.offset = region.offset / sizeof(T);
-        allocation.count  = count;
+        if(!TryAllocate(count, &allocation)){
+            throw std::runtime_error("GPU BUFFER OUT OF MEMORY");
+        }
         return allocation;
     }
     template<typename T>
     void Free(TBAllocation<T> allocation){
-        Region region{sizeof(T) * allocation.offset, sizeof(T) * allocation.count};
-        region_list.FreeRegion(region);
+        Free(Region{sizeof(T) * allocation.offset, sizeof(T) * allocation.count, allocation.page});
     }
     
-    RegionList region_list;
-    Buffer buffer;
+    Buffer*  GetBuffer(uint32_t page);
+    uint32_t PageCount();
+    // Destroys Pages Holding No Allocations, The First Page Is Kept
+    uint32_t ReleaseEmptyPages();
+    size_t FreeBytes();
+    size_t LargestFreeRegion();
+    // Free Space Split Across Pages Counts As Fragmented
+    float  Fragmentation();
+    
+    RelocationHandle Track(Region region, size_t alignment);
+    // Frees The Tracked Range, Or Defers It Until An In Flight Move Completes
+    void   FreeTracked(RelocationHandle handle);
+    void   ReleaseHandle(RelocationHandle handle);
+    Region Resolve(RelocationHandle handle);
+    template<typename T>
+    RelocationHandle Track(TBAllocation<T> allocation){
+        return Track(Region{sizeof(T) * allocation.offset, sizeof(T) * allocation.count, allocation.page}, sizeof(T));
+    }
+    template<typename T>
+    TBAllocation<T> Resolve(RelocationHandle handle, TBAllocation<T> allocation){
+        allocation.offset = (uint32_t)(relocatables[handle].region.offset / sizeof(T));
+        allocation.page   = relocatables[handle].region.page;
+        return allocation;
+    }
+    
+    BufferInfo page_info{};
+    uint32_t   max_page_count = 0;
+    // Released Pages Leave An Empty Slot So Page Indices Stay Stable
+    std::vector<std::unique_ptr<BufferPage>> pages;
+    // Indexed By RelocationHandle
+    std::vector<Relocatable>      relocatables;
+    std::vector<RelocationHandle> free_handles;
 };
 extern SuballocatedBuffer gpu_buffer;
 }
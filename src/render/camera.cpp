@@ -1,11 +1,6 @@
 #include "camera.h"
 
 namespace render{
-render::PushConstantRange Camera::PushConstantRange(uint32_t offset){
-    return {
-        render::SHADER_STAGE_VERTEX, offset, sizeof(glm::mat4),
-    };
-}
 glm::mat4 Camera::GetViewProjection(float aspect_ratio){
     glm::vec3 direction;
     direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
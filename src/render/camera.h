@@ -14,7 +14,6 @@
 namespace render{
 class Camera{
 public:
-    static render::PushConstantRange PushConstantRange(uint32_t offset);
     glm::mat4 GetViewProjection(float aspect_ratio);
     
     glm::vec3 position = glm::vec3(0.0f, 0.0f, -5.0f);
@@ -46,7 +46,10 @@ void CommandManager::Initialize(){
     vkAllocateCommandBuffers(render::context.vk_device, &allocate_info,
                              primary_graphics_command_buffers.data());
     
-    wt_record = std::thread([this]{ while(wt_active) { WTRecord(); } });
+    wt_record = std::thread([this]{
+        PROFILE_THREAD("Record Thread");
+        while(wt_active) { WTRecord(); }
+    });
 }
 void CommandManager::Terminate(){
     vkDeviceWaitIdle(render::context.vk_device);
@@ -60,10 +63,13 @@ void CommandManager::Terminate(){
 CommandBuffer* CommandManager::RecordAsync(std::function<void(VkCommandBuffer)> record_function){
     CommandBuffer* command_buffer = new CommandBuffer{};
     command_buffer->vk_command_buffer = primary_graphics_command_buffers[frame];
+    const uint32_t record_frame = frame;
     frame = (frame + 1) % 2;
     
     wt_record_mutex.lock();
-    wt_record_queue.emplace_back([this, record_function, command_buffer]{
+    wt_record_queue.emplace_back([this, record_function, command_buffer, record_frame]{
+        PROFILE_ZONE("Record Command Buffer");
+        auto start = std::chrono::high_resolution_clock::now();
         vkResetCommandBuffer(command_buffer->vk_command_buffer, 0);
         VkCommandBufferBeginInfo begin_info{};
         begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -71,7 +77,14 @@ CommandBuffer* CommandManager::RecordAsync(std::function<void(VkCommandBuffer)>
         begin_info.flags = 0;
         begin_info.pInheritanceInfo = nullptr;
         vkBeginCommandBuffer(command_buffer->vk_command_buffer, &begin_info);
-        record_function(command_buffer->vk_command_buffer);
+        render::gpu_profiler.SetRecordingFrame(record_frame);
+        {
+            PROFILE_GPU_ZONE(command_buffer->vk_command_buffer, "Frame Command Buffer");
+            record_function(command_buffer->vk_command_buffer);
+        }
+        auto finish = std::chrono::high_resolution_clock::now();
+        command_buffer->record_milliseconds =
+        std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() / 1000.0f;
     });
     wt_record_mutex.unlock();
     wt_record_condition_variable.notify_one();
@@ -102,9 +115,16 @@ void CommandManager::WTRecord(){
 }
 
 
+// Submits And Presents Share One Id Sequence, So Queue Access From The Threadpool Happens In Dispatch Order
+// And The Graphics Queue Is Never Used By Two Workers At Once
 void CommandManager::SubmitAsync(SubmitInfo submit_info, CommandBuffer* command_buffer){
     uint32_t id = submit_id++;
     core::threadpool.Dispatch([this, submit_info, command_buffer, id]{
+        if(id != to_submit_id){
+            return core::Threadpool::TASK_NOT_READY;
+        }
+        PROFILE_ZONE("Submit Command Buffer");
+        auto start = std::chrono::high_resolution_clock::now();
         vkEndCommandBuffer(command_buffer->vk_command_buffer);
 
         VkSubmitInfo vk_submit_info{};
@@ -122,6 +142,9 @@ void CommandManager::SubmitAsync(SubmitInfo submit_info, CommandBuffer* command_
         vk_submit_info.pCommandBuffers    = &command_buffer->vk_command_buffer;
         
         vkQueueSubmit(render::context.graphics_queue.vk_queue, 1, &vk_submit_info, submit_info.fence->vk_fence);
+        auto finish = std::chrono::high_resolution_clock::now();
+        command_buffer->submit_milliseconds =
+        std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count() / 1000.0f;
 
         ++to_submit_id;
         if(submit_info.fence != nullptr){
@@ -141,6 +164,7 @@ void CommandManager::PresentAsync(PresentInfo present_info){
         if(id != to_submit_id){
             return core::Threadpool::TASK_NOT_READY;
         }
+        PROFILE_ZONE("Present");
         
         VkPresentInfoKHR vk_present_info{};
         vk_present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -164,6 +188,7 @@ void CommandManager::PresentAsync(PresentInfo present_info){
 }
 
 void CommandManager::WaitForFence(Fence* fence){
+    PROFILE_FUNCTION();
     std::unique_lock<std::mutex> lock(submission_mutex);
     submission_condition_variable.wait(lock, [fence]{
         return fence->submission_flag;
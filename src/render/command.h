@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <mutex>
@@ -6,9 +7,11 @@
 
 #include <atomic>
 #include "thread_pool.h"
+#include "profiler.h"
 
 #include "render/context.h"
 #include "render/swapchain.h"
+#include "render/gpu_profiler.h"
 
 namespace render{
 struct Semaphore{
@@ -46,6 +49,10 @@ class CommandBuffer{
 public:
     bool record_submission_complete = false;
     VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+    
+    // CPU Time Spent Recording On The Record Thread And In vkEndCommandBuffer Plus vkQueueSubmit
+    float record_milliseconds = 0.0f;
+    float submit_milliseconds = 0.0f;
 };
 
 class CommandManager{
@@ -40,14 +40,22 @@ void Context::Initalize(ContextInfo info){
     extension_names.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
     extension_names.emplace_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
     
-    unsigned int window_extension_count = 0;
-    info.window->GetInstanceExtensions(&window_extension_count, nullptr);
-    const char** window_extension_names = new const char*[window_extension_count];
-    info.window->GetInstanceExtensions(&window_extension_count, window_extension_names);
-    for(unsigned int i = 0; i < window_extension_count; i++){
-        extension_names.emplace_back(window_extension_names[i]);
+    headless = info.headless;
+    if(!headless){
+        unsigned int window_extension_count = 0;
+        info.window->GetInstanceExtensions(&window_extension_count, nullptr);
+        const char** window_extension_names = new const char*[window_extension_count];
+        info.window->GetInstanceExtensions(&window_extension_count, window_extension_names);
+        for(unsigned int i = 0; i < window_extension_count; i++){
+            extension_names.emplace_back(window_extension_names[i]);
+        }
+        delete[] window_extension_names;
+    }
+    // Machines Without The Vulkan SDK Have No Validation Layer, They Run Without It
+    if(info.enable_validation_layers && !vkutil::InstanceLayerSupported("VK_LAYER_KHRONOS_validation")){
+        printf("VALIDATION LAYER REQUESTED BUT NOT INSTALLED, RUNNING WITHOUT IT\n");
+        info.enable_validation_layers = false;
     }
-    delete[] window_extension_names;
     if(info.enable_validation_layers){
         extension_names.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
@@ -110,8 +118,9 @@ void Context::Initalize(ContextInfo info){
     
     
     std::vector<const char*> device_extension_names{};
-    device_extension_names.emplace_back("VK_KHR_portability_subset");
-    device_extension_names.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if(!headless){
+        device_extension_names.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
     
     uint32_t physical_device_count;
     vkEnumeratePhysicalDevices(vk_instance, &physical_device_count, nullptr);
@@ -146,18 +155,123 @@ void Context::Initalize(ContextInfo info){
             device_queue_create_info.emplace_back(queue_create_info);
         }
         
+        VkPhysicalDeviceFeatures supported_features{};
+        vkGetPhysicalDeviceFeatures(vk_physical_device, &supported_features);
         VkPhysicalDeviceFeatures device_features{};
+        device_features.samplerAnisotropy = supported_features.samplerAnisotropy;
+        max_sampler_anisotropy = 0.0f;
+        if(supported_features.samplerAnisotropy){
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(vk_physical_device, &properties);
+            max_sampler_anisotropy = properties.limits.maxSamplerAnisotropy;
+        }
+        
+        // Optional Extensions Are Enabled Per Device, Only When Both Extension And Feature Are Present
+        std::vector<const char*> enabled_extension_names = device_extension_names;
+        void* device_create_next = nullptr;
+        
+        // Required On Portability Implementations Only, Software Drivers Such As Lavapipe Do Not Expose It
+        if(vkutil::DeviceExtensionSupported(vk_physical_device, "VK_KHR_portability_subset")){
+            enabled_extension_names.emplace_back("VK_KHR_portability_subset");
+        }
+        
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipeline_library_features{};
+        pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+        pipeline_library_features.pNext = nullptr;
+        graphics_pipeline_library_supported = false;
+        if(vkutil::DeviceExtensionSupported(vk_physical_device, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+           vkutil::DeviceExtensionSupported(vk_physical_device, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)){
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &pipeline_library_features;
+            vkGetPhysicalDeviceFeatures2(vk_physical_device, &features);
+            if(pipeline_library_features.graphicsPipelineLibrary){
+                enabled_extension_names.emplace_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                enabled_extension_names.emplace_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+                pipeline_library_features.pNext = device_create_next;
+                device_create_next = &pipeline_library_features;
+                graphics_pipeline_library_supported = true;
+            }
+        }
+        
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features{};
+        descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        descriptor_indexing_features.pNext = nullptr;
+        descriptor_indexing_supported = false;
+        if(vkutil::DeviceExtensionSupported(vk_physical_device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)){
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &descriptor_indexing_features;
+            vkGetPhysicalDeviceFeatures2(vk_physical_device, &features);
+            if(descriptor_indexing_features.runtimeDescriptorArray &&
+               descriptor_indexing_features.descriptorBindingPartiallyBound &&
+               descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+               descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing){
+                // Only The Features The Bindless Texture Table Relies On Are Enabled
+                VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabled_features{};
+                enabled_features.runtimeDescriptorArray                        = VK_TRUE;
+                enabled_features.descriptorBindingPartiallyBound               = VK_TRUE;
+                enabled_features.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+                enabled_features.shaderSampledImageArrayNonUniformIndexing     = VK_TRUE;
+                descriptor_indexing_features = enabled_features;
+                descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+                
+                enabled_extension_names.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+                descriptor_indexing_features.pNext = device_create_next;
+                device_create_next = &descriptor_indexing_features;
+                descriptor_indexing_supported = true;
+                
+                VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties{};
+                indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+                VkPhysicalDeviceProperties2 properties{};
+                properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+                properties.pNext = &indexing_properties;
+                vkGetPhysicalDeviceProperties2(vk_physical_device, &properties);
+                max_update_after_bind_sampled_images =
+                std::min(indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                         indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+            }
+        }
+        
+        VkPhysicalDeviceHostQueryResetFeatures host_query_reset_features{};
+        host_query_reset_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
+        host_query_reset_features.pNext = nullptr;
+        host_query_reset_supported = false;
+        {
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features.pNext = &host_query_reset_features;
+            vkGetPhysicalDeviceFeatures2(vk_physical_device, &features);
+            if(host_query_reset_features.hostQueryReset){
+                host_query_reset_features.pNext = device_create_next;
+                device_create_next = &host_query_reset_features;
+                host_query_reset_supported = true;
+            }
+        }
+        
+        // Without It VMA Estimates Budgets From Heap Sizes And Its Own Allocations
+        memory_budget_supported = false;
+        if(vkutil::DeviceExtensionSupported(vk_physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)){
+            enabled_extension_names.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            memory_budget_supported = true;
+        }
+        
+        push_descriptor_supported = false;
+        if(vkutil::DeviceExtensionSupported(vk_physical_device, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)){
+            enabled_extension_names.emplace_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+            push_descriptor_supported = true;
+        }
         
         VkDeviceCreateInfo device_create_info{};
         device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        device_create_info.pNext = nullptr;
+        device_create_info.pNext = device_create_next;
         device_create_info.flags = 0;
         
         device_create_info.queueCreateInfoCount = (uint32_t)device_queue_create_info.size();
         device_create_info.pQueueCreateInfos    = device_queue_create_info.data();
         
-        device_create_info.enabledExtensionCount   = (uint32_t)device_extension_names.size();
-        device_create_info.ppEnabledExtensionNames = device_extension_names.data();
+        device_create_info.enabledExtensionCount   = (uint32_t)enabled_extension_names.size();
+        device_create_info.ppEnabledExtensionNames = enabled_extension_names.data();
         device_create_info.enabledLayerCount   = (uint32_t)layer_names.size();
         device_create_info.ppEnabledLayerNames = layer_names.data();
         device_create_info.pEnabledFeatures = &device_features;
@@ -173,13 +287,31 @@ void Context::Initalize(ContextInfo info){
     graphics_queue.vk_family_index = queue_indices.graphics_family_index;
     vkGetDeviceQueue(vk_device, graphics_queue.vk_family_index, 0, &graphics_queue.vk_queue);
     
+    {
+        uint32_t queue_family_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(vk_physical_device, &queue_family_count, nullptr);
+        std::vector<VkQueueFamilyProperties> queue_family_properties(queue_family_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(vk_physical_device, &queue_family_count, queue_family_properties.data());
+        timestamp_valid_bits = queue_family_properties[graphics_queue.vk_family_index].timestampValidBits;
+        
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(vk_physical_device, &properties);
+        timestamp_period = properties.limits.timestampPeriod;
+    }
+    
+    if(push_descriptor_supported){
+        vk_cmd_push_descriptor_set =
+        (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(vk_device, "vkCmdPushDescriptorSetKHR");
+        push_descriptor_supported = vk_cmd_push_descriptor_set != nullptr;
+    }
+    
     
     VmaVulkanFunctions vma_vulkan_functions = {};
     vma_vulkan_functions.vkGetInstanceProcAddr = &vkGetInstanceProcAddr;
     vma_vulkan_functions.vkGetDeviceProcAddr = &vkGetDeviceProcAddr;
     
     VmaAllocatorCreateInfo allocator_create_info = {};
-    allocator_create_info.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    allocator_create_info.flags = memory_budget_supported ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
     allocator_create_info.vulkanApiVersion = VK_API_VERSION_1_2;
     allocator_create_info.physicalDevice = vk_physical_device;
     allocator_create_info.device = vk_device;
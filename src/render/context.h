@@ -40,9 +40,12 @@ struct DeviceHeap{
 };
 struct ContextInfo{
     Window* window;
+    // Skipped With A Message When The Khronos Validation Layer Is Not Installed
     bool enable_validation_layers;
     const char* applcation_name; 
     const char* engine_name;
+    // Headless Contexts Need No Window And Enable No Surface Or Swapchain Extensions
+    bool headless;
 };
 class Context{
 public:
@@ -50,7 +53,7 @@ public:
     void Terminate();
     
     VkInstance vk_instance;
-    VkDebugUtilsMessengerEXT vk_debug_utils_messenger;
+    VkDebugUtilsMessengerEXT vk_debug_utils_messenger = VK_NULL_HANDLE;
     
     VkPhysicalDevice vk_physical_device;
     VkDevice vk_device;
@@ -59,6 +62,19 @@ public:
     DeviceQueue transfer_queue;
     DeviceQueue present_queue;
     
+    bool headless = false;
+    bool graphics_pipeline_library_supported = false;
+    bool descriptor_indexing_supported = false;
+    bool push_descriptor_supported = false;
+    float max_sampler_anisotropy = 0.0f;
+    // Zero Valid Bits Means The Graphics Queue Cannot Write Timestamps
+    bool host_query_reset_supported = false;
+    bool memory_budget_supported = false;
+    uint32_t timestamp_valid_bits = 0;
+    float timestamp_period = 0.0f;
+    PFN_vkCmdPushDescriptorSetKHR vk_cmd_push_descriptor_set = nullptr;
+    uint32_t max_update_after_bind_sampled_images = 0;
+    
     VmaAllocator allocator;
 };
 extern Context context;
@@ -0,0 +1,122 @@
+#include "render/defragmenter.h"
+#include "render/staging.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <map>
+
+namespace render{
+Defragmenter gpu_buffer_defragmenter{};
+void Defragmenter::Initialize(SuballocatedBuffer* buffer, DefragmenterInfo info){
+    buffer_ = buffer;
+    info_   = info;
+}
+// Pending Copies Are Abandoned, Every Range Is Released With The Buffer
+void Defragmenter::Terminate(){
+    moves_.clear();
+    retired_regions_.clear();
+    buffer_ = nullptr;
+}
+
+void Defragmenter::Update(uint64_t frame){
+    PROFILE_FUNCTION();
+    for(auto iterator = retired_regions_.begin(); iterator != retired_regions_.end();){
+        if(iterator->frame + info_.frame_count > frame){
+            ++iterator;
+            continue;
+        }
+        buffer_->Free(iterator->region);
+        iterator = retired_regions_.erase(iterator);
+    }
+    
+    // Moves Recorded Last Frame Land Once The Staging Batch Carrying Them Has Completed
+    if(render::staging_manager.recording || !render::staging_manager.IsUploadComplete()){
+        return;
+    }
+    if(!moves_.empty()){
+        CompleteMoves(frame);
+        return;
+    }
+    // Nothing In Flight References A Page Once Its Last Range Has Been Freed
+    statistics.released_page_count += buffer_->ReleaseEmptyPages();
+    if(buffer_->Fragmentation() < info_.fragmentation_threshold){
+        return;
+    }
+    PlanMoves();
+}
+
+void Defragmenter::CompleteMoves(uint64_t frame){
+    for(const Move& move : moves_){
+        Relocatable& relocatable = buffer_->relocatables[move.handle];
+        relocatable.moving = false;
+        retired_regions_.push_back({ move.source, frame });
+        if(!relocatable.live){
+            // Freed While Moving, Neither Range Is Referenced Any More
+            buffer_->Free(move.destination);
+            buffer_->ReleaseHandle(move.handle);
+            continue;
+        }
+        relocatable.region = move.destination;
+    }
+    moves_.clear();
+}
+
+void Defragmenter::PlanMoves(){
+    PROFILE_FUNCTION();
+    static core::MetricCounter* moved_byte_counter = core::metrics.Counter("gpu_buffer_bytes_relocated");
+    
+    std::vector<RelocationHandle> candidates;
+    for(RelocationHandle handle = 0; handle < buffer_->relocatables.size(); handle++){
+        if(buffer_->relocatables[handle].live && !buffer_->relocatables[handle].moving){
+            candidates.emplace_back(handle);
+        }
+    }
+    auto lower = [](const Region& a, const Region& b){
+        return a.page < b.page || (a.page == b.page && a.offset < b.offset);
+    };
+    std::sort(candidates.begin(), candidates.end(), [this, lower](RelocationHandle a, RelocationHandle b){
+        return lower(buffer_->relocatables[b].region, buffer_->relocatables[a].region);
+    });
+    
+    // Copies Are Grouped By Source And Destination Page, One vkCmdCopyBuffer Each
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<VkBufferCopy>> copies;
+    VkDeviceSize moved_bytes = 0;
+    uint32_t move_count = 0;
+    for(RelocationHandle handle : candidates){
+        Relocatable& relocatable = buffer_->relocatables[handle];
+        const Region source = relocatable.region;
+        if(moved_bytes > 0 && moved_bytes + source.size > info_.move_bytes_per_frame){
+            break;
+        }
+        // First Fit Returns The Lowest Hole, A Range Already Below It Stays Put
+        Region destination;
+        if(!buffer_->TryAllocate(source.size, relocatable.alignment, &destination, false)){
+            continue;
+        }
+        if(!lower(destination, source)){
+            buffer_->Free(destination);
+            continue;
+        }
+        relocatable.moving = true;
+        moves_.push_back({ handle, source, destination });
+        
+        VkBufferCopy copy{};
+        copy.srcOffset = source.offset;
+        copy.dstOffset = destination.offset;
+        copy.size      = source.size;
+        copies[{ source.page, destination.page }].emplace_back(copy);
+        moved_bytes += source.size;
+        move_count++;
+    }
+    if(copies.empty()){
+        return;
+    }
+    for(auto& [pages, page_copies] : copies){
+        render::staging_manager.CopyBuffer(buffer_->GetBuffer(pages.first), buffer_->GetBuffer(pages.second), page_copies);
+    }
+    statistics.move_count  += move_count;
+    statistics.moved_bytes += moved_bytes;
+    statistics.pass_count++;
+    moved_byte_counter->Add(moved_bytes);
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+#include "render/buffer.h"
+
+namespace render{
+struct DefragmenterInfo{
+    uint32_t frame_count = 2;
+    VkDeviceSize move_bytes_per_frame = 16 * 1024 * 1024;
+    // Share Of Free Memory Outside The Largest Free Region Before Compaction Starts
+    float fragmentation_threshold = 0.25f;
+};
+struct DefragmenterStatistics{
+    uint32_t move_count;
+    VkDeviceSize moved_bytes;
+    uint32_t pass_count;
+    uint32_t released_page_count;
+};
+
+// Incrementally Compacts A SuballocatedBuffer Towards Its First Pages: Each Pass Moves The Highest Tracked
+// Ranges Into The Lowest Holes That Fit, Repoints The Relocation Handles Once The Copies Complete, Frees
+// The Old Ranges After The Frames In Flight That May Still Draw From Them And Releases Emptied Pages
+class Defragmenter{
+public:
+    void Initialize(SuballocatedBuffer* buffer, DefragmenterInfo info = {});
+    void Terminate();
+    
+    // Called On The Main Thread After The Streamers, Before The Frame's SubmitUpload
+    void Update(uint64_t frame);
+    
+    DefragmenterStatistics statistics{};
+    
+private:
+    void CompleteMoves(uint64_t frame);
+    void PlanMoves();
+    
+    struct Move{
+        RelocationHandle handle;
+        Region source;
+        Region destination;
+    };
+    struct RetiredRegion{
+        Region   region;
+        uint64_t frame;
+    };
+    SuballocatedBuffer* buffer_ = nullptr;
+    DefragmenterInfo info_{};
+    std::vector<Move>          moves_{};
+    std::vector<RetiredRegion> retired_regions_{};
+};
+extern Defragmenter gpu_buffer_defragmenter;
+}
@@ -1,11 +1,17 @@
 #include "render/descriptor.h"
 
+#include <algorithm>
+
+#include "metrics.h"
+
 namespace render{
-void DescriptorSetLayout::Initialize(std::vector<DescriptorBinding> bindings){
+void DescriptorSetLayout::Initialize(std::vector<DescriptorBinding> bindings, VkDescriptorSetLayoutCreateFlags flags){
+    this->bindings = bindings;
+    this->flags    = flags;
     VkDescriptorSetLayoutCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     create_info.pNext = nullptr;
-    create_info.flags = 0;
+    create_info.flags = flags;
     create_info.bindingCount = (uint32_t)bindings.size();
     create_info.pBindings    = (VkDescriptorSetLayoutBinding*)bindings.data();
     
@@ -15,8 +21,172 @@ void DescriptorSetLayout::Terminate(){
     vkDestroyDescriptorSetLayout(render::context.vk_device, vk_descriptor_set_layout, nullptr);
 }
 
+DescriptorSetLayoutCache descriptor_set_layout_cache{};
+void DescriptorSetLayoutCache::Initialize(){}
+void DescriptorSetLayoutCache::Terminate(){
+    for(auto& [key, set_layout] : layout_map){
+        set_layout.Terminate();
+    }
+    layout_map.clear();
+}
+
+DescriptorSetLayout DescriptorSetLayoutCache::Get(std::vector<DescriptorBinding> bindings,
+                                                  VkDescriptorSetLayoutCreateFlags flags){
+    std::sort(bindings.begin(), bindings.end(), [](const DescriptorBinding& a, const DescriptorBinding& b){
+        return a.binding < b.binding;
+    });
+    StateKey key{};
+    key.words.emplace_back(flags);
+    for(const DescriptorBinding& binding : bindings){
+        key.words.emplace_back(((uint64_t)binding.binding << 32) | (uint64_t)binding.descriptorType);
+        key.words.emplace_back(((uint64_t)binding.descriptorCount << 32) | (uint64_t)binding.stageFlags);
+        key.words.emplace_back((uint64_t)binding.pImmutableSamplers);
+    }
+    key.Finalize();
+    
+    std::lock_guard<std::mutex> lock(layout_map_mutex);
+    auto iterator = layout_map.find(key);
+    if(iterator != layout_map.end()){
+        return iterator->second;
+    }
+    DescriptorSetLayout set_layout{};
+    set_layout.Initialize(bindings, flags);
+    layout_map.emplace(std::move(key), set_layout);
+    return set_layout;
+}
+
+void DescriptorWriter::WriteImage(VkDescriptorSet vk_descriptor_set, uint32_t binding, uint32_t index,
+                                  VkDescriptorType type, VkImageView vk_view, VkImageLayout vk_layout,
+                                  VkSampler vk_sampler){
+    VkDescriptorImageInfo& image_info = image_infos.emplace_back();
+    image_info.imageView   = vk_view;
+    image_info.imageLayout = vk_layout;
+    image_info.sampler     = vk_sampler;
+    
+    VkWriteDescriptorSet set_write{};
+    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set_write.descriptorType  = type;
+    set_write.descriptorCount = 1;
+    set_write.dstBinding      = binding;
+    set_write.dstArrayElement = index;
+    set_write.dstSet     = vk_descriptor_set;
+    set_write.pImageInfo = &image_info;
+    writes.emplace_back(set_write);
+}
+void DescriptorWriter::WriteBuffer(VkDescriptorSet vk_descriptor_set, uint32_t binding, uint32_t index,
+                                   VkDescriptorType type, VkBuffer vk_buffer, VkDeviceSize offset,
+                                   VkDeviceSize range){
+    VkDescriptorBufferInfo& buffer_info = buffer_infos.emplace_back();
+    buffer_info.buffer = vk_buffer;
+    buffer_info.offset = offset;
+    buffer_info.range  = range;
+    
+    VkWriteDescriptorSet set_write{};
+    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set_write.descriptorType  = type;
+    set_write.descriptorCount = 1;
+    set_write.dstBinding      = binding;
+    set_write.dstArrayElement = index;
+    set_write.dstSet      = vk_descriptor_set;
+    set_write.pBufferInfo = &buffer_info;
+    writes.emplace_back(set_write);
+}
+void DescriptorWriter::Flush(){
+    if(!writes.empty()){
+        vkUpdateDescriptorSets(render::context.vk_device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+    }
+    writes.clear();
+    image_infos.clear();
+    buffer_infos.clear();
+}
+
+// Writes Go Straight Into The Command Buffer, The Destination Set Of Each Write Is Ignored
+void DescriptorWriter::Push(VkCommandBuffer vk_command_buffer, VkPipelineLayout vk_pipeline_layout, uint32_t set){
+    if(!writes.empty()){
+        render::context.vk_cmd_push_descriptor_set(vk_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                   vk_pipeline_layout, set,
+                                                   (uint32_t)writes.size(), writes.data());
+    }
+    writes.clear();
+    image_infos.clear();
+    buffer_infos.clear();
+}
+
+void DescriptorUpdateTemplate::Initialize(const DescriptorSetLayout& set_layout){
+    std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+    for(const DescriptorBinding& binding : set_layout.bindings){
+        VkDescriptorUpdateTemplateEntry entry{};
+        entry.dstBinding      = binding.binding;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = binding.descriptorCount;
+        entry.descriptorType  = binding.descriptorType;
+        entry.offset = descriptor_count * sizeof(DescriptorData);
+        entry.stride = sizeof(DescriptorData);
+        entries.emplace_back(entry);
+        descriptor_count += binding.descriptorCount;
+    }
+    
+    VkDescriptorUpdateTemplateCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    create_info.pNext = nullptr;
+    create_info.flags = 0;
+    create_info.descriptorUpdateEntryCount = (uint32_t)entries.size();
+    create_info.pDescriptorUpdateEntries   = entries.data();
+    create_info.templateType        = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    create_info.descriptorSetLayout = set_layout.vk_descriptor_set_layout;
+    VkResult vk_result = vkCreateDescriptorUpdateTemplate(render::context.vk_device, &create_info, nullptr,
+                                                          &vk_descriptor_update_template);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE DESCRIPTOR UPDATE TEMPLATE");
+    }
+}
+void DescriptorUpdateTemplate::Terminate(){
+    vkDestroyDescriptorUpdateTemplate(render::context.vk_device, vk_descriptor_update_template, nullptr);
+    vk_descriptor_update_template = VK_NULL_HANDLE;
+}
+void DescriptorUpdateTemplate::Update(VkDescriptorSet vk_descriptor_set, const DescriptorData* data){
+    vkUpdateDescriptorSetWithTemplate(render::context.vk_device, vk_descriptor_set,
+                                      vk_descriptor_update_template, data);
+}
+
+DescriptorUpdateTemplateCache descriptor_update_template_cache{};
+void DescriptorUpdateTemplateCache::Initialize(){}
+void DescriptorUpdateTemplateCache::Terminate(){
+    for(auto& [vk_set_layout, update_template] : template_map){
+        update_template->Terminate();
+    }
+    template_map.clear();
+}
+DescriptorUpdateTemplate* DescriptorUpdateTemplateCache::Get(const DescriptorSetLayout& set_layout){
+    std::lock_guard<std::mutex> lock(template_map_mutex);
+    std::unique_ptr<DescriptorUpdateTemplate>& update_template = template_map[set_layout.vk_descriptor_set_layout];
+    if(update_template == nullptr){
+        update_template = std::make_unique<DescriptorUpdateTemplate>();
+        update_template->Initialize(set_layout);
+    }
+    return update_template.get();
+}
+
 DescriptorAllocator descriptor_allocator{};
-void DescriptorAllocator::Initialize(){
+void DescriptorAllocator::Initialize(uint32_t frame_count, uint32_t thread_count){
+    this->frame_count  = frame_count;
+    this->thread_count = thread_count;
+    frame_pool_sets.resize(frame_count * thread_count);
+}
+void DescriptorAllocator::Terminate(){
+    for(DescriptorPoolSet& pool_set : frame_pool_sets){
+        for(VkDescriptorPool pool : pool_set.descriptor_pools){
+            vkDestroyDescriptorPool(render::context.vk_device, pool, nullptr);
+        }
+    }
+    frame_pool_sets.clear();
+    for(VkDescriptorPool pool : persistent_pool_set.descriptor_pools){
+        vkDestroyDescriptorPool(render::context.vk_device, pool, nullptr);
+    }
+    persistent_pool_set = {};
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t max_sets){
     std::vector<std::pair<VkDescriptorType,float>> pool_sizes = {
         { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
         { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.f },
@@ -33,87 +203,84 @@ void DescriptorAllocator::Initialize(){
     std::vector<VkDescriptorPoolSize> sizes;
     sizes.reserve(pool_sizes.size());
     for (auto size : pool_sizes) {
-        sizes.push_back({ size.first, uint32_t(size.second * pool_set_count) });
+        sizes.push_back({ size.first, uint32_t(size.second * max_sets) });
     }
     
     VkDescriptorPoolCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     create_info.flags = 0;
     create_info.pNext = nullptr;
-    create_info.maxSets = pool_set_count;
+    create_info.maxSets = max_sets;
     create_info.poolSizeCount = (uint32_t)sizes.size();
     create_info.pPoolSizes    = sizes.data();
     VkDescriptorPool new_pool{};
-    vkCreateDescriptorPool(render::context.vk_device,&create_info, nullptr, &new_pool);
-    descriptor_pools.emplace_back(new_pool);
-}
-void DescriptorAllocator::Terminate(){
-    for(VkDescriptorPool pool : descriptor_pools){
-        vkDestroyDescriptorPool(render::context.vk_device, pool, nullptr);
+    VkResult vk_result = vkCreateDescriptorPool(render::context.vk_device, &create_info, nullptr, &new_pool);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE DESCRIPTOR POOL");
     }
+    return new_pool;
 }
 
-DescriptorSet DescriptorAllocator::Allocate(DescriptorSetLayout set_layout){
+// Exhausted Pools Are Skipped, Not Reset, Until Their Frame Comes Around Again
+DescriptorSet DescriptorAllocator::AllocateFromPoolSet(DescriptorPoolSet* pool_set, DescriptorSetLayout set_layout){
+    static core::MetricCounter* allocation_counter = core::metrics.Counter("descriptor_allocations");
+    allocation_counter->Add();
+    
     VkDescriptorSetAllocateInfo allocate_info{};
     allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocate_info.pNext = nullptr;
-    allocate_info.descriptorPool = descriptor_pools[active_pool_index];
     allocate_info.descriptorSetCount = 1;
     allocate_info.pSetLayouts = &set_layout.vk_descriptor_set_layout;
+    
     DescriptorSet descriptor_set{};
-    VkResult vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &descriptor_set.vk_descriptor_set);
-    if(vk_result == VK_SUCCESS){
-        return descriptor_set;
-    }
-    while(++active_pool_index < descriptor_pools.size()){
-        allocate_info.descriptorPool = descriptor_pools[active_pool_index];
-        vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &descriptor_set.vk_descriptor_set);
+    for(; pool_set->active_pool_index < pool_set->descriptor_pools.size(); pool_set->active_pool_index++){
+        allocate_info.descriptorPool = pool_set->descriptor_pools[pool_set->active_pool_index];
+        VkResult vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &descriptor_set.vk_descriptor_set);
         if(vk_result == VK_SUCCESS){
             return descriptor_set;
         }
     }
     
-    std::vector<std::pair<VkDescriptorType,float>> pool_sizes = {
-        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
-        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.f },
-        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.f },
-        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.f },
-        { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1.f },
-        { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1.f },
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.f },
-        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.f },
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f },
-        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.f },
-        { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f }
-    };
-    std::vector<VkDescriptorPoolSize> sizes;
-    sizes.reserve(pool_sizes.size());
-    for (auto size : pool_sizes) {
-        sizes.push_back({ size.first, uint32_t(size.second * 1000) });
+    pool_set->descriptor_pools.emplace_back(CreatePool(pool_set_count));
+    allocate_info.descriptorPool = pool_set->descriptor_pools.back();
+    VkResult vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &descriptor_set.vk_descriptor_set);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO ALLOCATE DESCRIPTOR SET");
     }
-    
-    VkDescriptorPoolCreateInfo create_info{};
-    create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    create_info.flags = 0;
-    create_info.pNext = nullptr;
-    create_info.maxSets = 1000;
-    create_info.poolSizeCount = (uint32_t)sizes.size();
-    create_info.pPoolSizes    = sizes.data();
-    VkDescriptorPool new_pool{};
-    vkCreateDescriptorPool(render::context.vk_device,&create_info, nullptr, &new_pool);
-    descriptor_pools.emplace_back(new_pool);
-    
-    allocate_info.descriptorPool = new_pool;
-    vk_result = vkAllocateDescriptorSets(render::context.vk_device, &allocate_info, &descriptor_set.vk_descriptor_set);
-    if(vk_result == VK_SUCCESS){
-        return descriptor_set;
+    return descriptor_set;
+}
+
+// Each Thread Claims A Slot On First Use And Keeps It For Its Lifetime
+uint32_t DescriptorAllocator::GetThreadSlot(){
+    thread_local uint32_t thread_slot = UINT32_MAX;
+    if(thread_slot == UINT32_MAX){
+        thread_slot = next_thread_slot.fetch_add(1);
+        if(thread_slot >= thread_count){
+            throw std::runtime_error("MORE THREADS ALLOCATING DESCRIPTORS THAN DESCRIPTOR ALLOCATOR THREAD COUNT");
+        }
     }
+    return thread_slot;
 }
 
-void DescriptorAllocator::Flush(){
-    active_pool_index = 0;
-    for(VkDescriptorPool pool : descriptor_pools){
-        vkResetDescriptorPool(render::context.vk_device, pool, 0);
+DescriptorSet DescriptorAllocator::Allocate(DescriptorSetLayout set_layout, uint32_t frame){
+    DescriptorPoolSet* pool_set = &frame_pool_sets[(frame % frame_count) * thread_count + GetThreadSlot()];
+    return AllocateFromPoolSet(pool_set, set_layout);
+}
+DescriptorSet DescriptorAllocator::AllocatePersistent(DescriptorSetLayout set_layout){
+    std::lock_guard<std::mutex> lock(persistent_pool_set_mutex);
+    return AllocateFromPoolSet(&persistent_pool_set, set_layout);
+}
+
+void DescriptorAllocator::ResetFrame(uint32_t frame, VkFence vk_frame_fence){
+    if(vkGetFenceStatus(render::context.vk_device, vk_frame_fence) != VK_SUCCESS){
+        throw std::runtime_error("DESCRIPTOR POOLS RESET BEFORE FRAME FENCE SIGNALED");
+    }
+    for(uint32_t thread_slot = 0; thread_slot < thread_count; thread_slot++){
+        DescriptorPoolSet& pool_set = frame_pool_sets[(frame % frame_count) * thread_count + thread_slot];
+        for(VkDescriptorPool pool : pool_set.descriptor_pools){
+            vkResetDescriptorPool(render::context.vk_device, pool, 0);
+        }
+        pool_set.active_pool_index = 0;
     }
 }
 }
@@ -1,5 +1,12 @@
 #pragma once
 #include "render/context.h"
+#include "render/hash.h"
+
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
 
 namespace render{
 struct DescriptorBinding{
@@ -11,28 +18,104 @@ struct DescriptorBinding{
 };
 class DescriptorSetLayout{
 public:
-    void Initialize(std::vector<DescriptorBinding> bindings);
+    void Initialize(std::vector<DescriptorBinding> bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
     void Terminate();
     
+    std::vector<DescriptorBinding> bindings{};
+    VkDescriptorSetLayoutCreateFlags flags = 0;
     VkDescriptorSetLayout vk_descriptor_set_layout;
 };
 //VkDescriptorSetLayout CreateDescriptorSetLayout(std::vector<DescriptorBinding> bindings);
 
+// Identical Binding Lists Share One Layout, Destroyed When The Cache Terminates
+class DescriptorSetLayoutCache{
+public:
+    void Initialize();
+    void Terminate();
+    
+    DescriptorSetLayout Get(std::vector<DescriptorBinding> bindings, VkDescriptorSetLayoutCreateFlags flags = 0);
+    
+    std::mutex layout_map_mutex;
+    std::unordered_map<StateKey, DescriptorSetLayout, StateKeyHash> layout_map;
+};
+extern DescriptorSetLayoutCache descriptor_set_layout_cache;
+
 struct DescriptorSet{
     VkDescriptorSet vk_descriptor_set;
 };
-class DescriptorAllocator{
+
+// Accumulates Writes To Any Number Of Sets And Submits Them With A Single vkUpdateDescriptorSets
+class DescriptorWriter{
 public:
-    void Initialize();
+    void WriteImage (VkDescriptorSet vk_descriptor_set, uint32_t binding, uint32_t index, VkDescriptorType type,
+                     VkImageView vk_view, VkImageLayout vk_layout, VkSampler vk_sampler);
+    void WriteBuffer(VkDescriptorSet vk_descriptor_set, uint32_t binding, uint32_t index, VkDescriptorType type,
+                     VkBuffer vk_buffer, VkDeviceSize offset, VkDeviceSize range);
+    void Flush();
+    void Push(VkCommandBuffer vk_command_buffer, VkPipelineLayout vk_pipeline_layout, uint32_t set);
+    
+    // Deques Keep Info Addresses Stable While Writes Reference Them
+    std::deque<VkDescriptorImageInfo>  image_infos{};
+    std::deque<VkDescriptorBufferInfo> buffer_infos{};
+    std::vector<VkWriteDescriptorSet>  writes{};
+};
+
+// One Element Per Descriptor, In Binding Order, Consumed By A DescriptorUpdateTemplate
+union DescriptorData{
+    VkDescriptorImageInfo  image;
+    VkDescriptorBufferInfo buffer;
+    VkBufferView           texel_buffer_view;
+};
+// Writes Every Binding Of A Layout From One DescriptorData Array In A Single Call
+class DescriptorUpdateTemplate{
+public:
+    void Initialize(const DescriptorSetLayout& set_layout);
     void Terminate();
     
-    DescriptorSet Allocate(DescriptorSetLayout set_layout);
+    void Update(VkDescriptorSet vk_descriptor_set, const DescriptorData* data);
     
-    void Flush();
+    uint32_t descriptor_count = 0;
+    VkDescriptorUpdateTemplate vk_descriptor_update_template = VK_NULL_HANDLE;
+};
+class DescriptorUpdateTemplateCache{
+public:
+    void Initialize();
+    void Terminate();
+    
+    DescriptorUpdateTemplate* Get(const DescriptorSetLayout& set_layout);
     
-    uint32_t pool_set_count = 3;
+    std::mutex template_map_mutex;
+    std::unordered_map<VkDescriptorSetLayout, std::unique_ptr<DescriptorUpdateTemplate>> template_map;
+};
+extern DescriptorUpdateTemplateCache descriptor_update_template_cache;
+struct DescriptorPoolSet{
     uint32_t active_pool_index = 0;
     std::vector<VkDescriptorPool> descriptor_pools{};
 };
+// Transient Sets Come From Pools Owned By One Thread For One Frame In Flight, So Allocation
+// Takes No Lock And A Frame's Pools Are Only Reset Once Its Fence Has Signaled
+class DescriptorAllocator{
+public:
+    void Initialize(uint32_t frame_count, uint32_t thread_count);
+    void Terminate();
+    
+    DescriptorSet Allocate(DescriptorSetLayout set_layout, uint32_t frame);
+    DescriptorSet AllocatePersistent(DescriptorSetLayout set_layout);
+    
+    void ResetFrame(uint32_t frame, VkFence vk_frame_fence);
+    
+    VkDescriptorPool CreatePool(uint32_t max_sets);
+    DescriptorSet    AllocateFromPoolSet(DescriptorPoolSet* pool_set, DescriptorSetLayout set_layout);
+    uint32_t         GetThreadSlot();
+    
+    uint32_t frame_count  = 0;
+    uint32_t thread_count = 0;
+    uint32_t pool_set_count = 1000;
+    std::atomic<uint32_t> next_thread_slot = 0;
+    std::vector<DescriptorPoolSet> frame_pool_sets{};
+    
+    std::mutex persistent_pool_set_mutex;
+    DescriptorPoolSet persistent_pool_set{};
+};
 extern DescriptorAllocator descriptor_allocator;
 }
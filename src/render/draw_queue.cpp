@@ -0,0 +1,151 @@
+#include "render/draw_queue.h"
+#include "metrics.h"
+
+#include <algorithm>
+
+namespace render{
+uint64_t CreateSortKey(DrawKey key){
+    return ((uint64_t)(key.pass     & 0xF)   << 60) |
+           ((uint64_t)(key.pipeline & 0xFFF) << 48) |
+           ((uint64_t)(key.descriptor_set & 0xFFF) << 36) |
+           ((uint64_t)(key.vertex_buffer_page & 0xF) << 32) |
+           ((uint64_t)(key.index_buffer_page  & 0xF) << 28) |
+           ((uint64_t)(key.mesh & 0xFFF)     << 16) |
+            (uint64_t) key.depth;
+}
+uint16_t QuantizeDepth(float view_depth, float z_near, float z_far){
+    float normalized = (view_depth - z_near) / (z_far - z_near);
+    normalized = std::clamp(normalized, 0.0f, 1.0f);
+    return (uint16_t)(normalized * UINT16_MAX);
+}
+
+void DrawQueue::Submit(DrawKey key, DrawPacket packet){
+    key.descriptor_set = (uint16_t)HashValue(packet.descriptor_set.vk_descriptor_set);
+    key.vertex_buffer_page = (uint8_t)packet.vertex_buffer_page;
+    key.index_buffer_page  = (uint8_t)packet.index_buffer_page;
+    key.mesh = (uint16_t)HashValue(packet.vertex_offset, HashValue(packet.first_index, HashValue(packet.vertex_buffer)));
+    entries_.push_back({ CreateSortKey(key), (uint32_t)packets_.size() });
+    packets_.emplace_back(packet);
+}
+
+// LSD Radix Sort, 8 Bits Per Pass. Passes Where Every Key Shares The Same Byte Are Skipped
+void DrawQueue::Sort(){
+    const size_t entry_count = entries_.size();
+    if(entry_count < 2){
+        return;
+    }
+    scratch_.resize(entry_count);
+
+    uint32_t counts[256];
+    for(uint32_t shift = 0; shift < 64; shift += 8){
+        std::fill(counts, counts + 256, 0);
+        for(const SortEntry& entry : entries_){
+            counts[(entry.key >> shift) & 0xFF]++;
+        }
+        if(counts[(entries_[0].key >> shift) & 0xFF] == entry_count){
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for(uint32_t& count : counts){
+            uint32_t bucket_size = count;
+            count   = offset;
+            offset += bucket_size;
+        }
+        for(const SortEntry& entry : entries_){
+            scratch_[counts[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries_.swap(scratch_);
+    }
+}
+
+void DrawQueue::Record(VkCommandBuffer vk_command_buffer, uint32_t push_constant_size, void* push_constant_data){
+    statistics = {};
+
+    Pipeline*        bound_pipeline        = nullptr;
+    VkPipelineLayout bound_pipeline_layout = VK_NULL_HANDLE;
+    VkDescriptorSet  bound_descriptor_set  = VK_NULL_HANDLE;
+    uint32_t         bound_descriptor_set_binding = 0;
+    uint32_t         pushed_texture_index  = BINDLESS_INVALID_INDEX;
+    Buffer* bound_vertex_buffer = nullptr;
+    Buffer* bound_index_buffer  = nullptr;
+
+    for(const SortEntry& entry : entries_){
+        const DrawPacket& packet = packets_[entry.packet_index];
+
+        // Pipelines Still Compiling On The Threadpool Are Drawn With Their Fallback Or Skipped
+        Pipeline* pipeline = render::pipeline_manager.Resolve(packet.pipeline);
+        if(pipeline == nullptr){
+            statistics.skipped_draw_count++;
+            continue;
+        }
+        if(pipeline != packet.pipeline){
+            statistics.fallback_draw_count++;
+        }
+
+        if(pipeline != bound_pipeline){
+            pipeline->Bind(vk_command_buffer);
+            bound_pipeline = pipeline;
+            statistics.pipeline_bind_count++;
+
+            // Descriptor Sets And Push Constants Are Only Disturbed By An Incompatible Layout
+            if(pipeline->vk_pipeline_layout != bound_pipeline_layout){
+                bound_pipeline_layout = pipeline->vk_pipeline_layout;
+                bound_descriptor_set  = VK_NULL_HANDLE;
+                pushed_texture_index  = BINDLESS_INVALID_INDEX;
+                if(push_constant_size != 0){
+                    pipeline->PushConstant(vk_command_buffer, push_constant_size, 0, push_constant_data);
+                }
+                if(pipeline->bindless_set_index != UINT32_MAX){
+                    render::bindless_table.Bind(vk_command_buffer, bound_pipeline_layout, pipeline->bindless_set_index);
+                    statistics.descriptor_set_bind_count++;
+                }
+            }
+        }
+        // Bindless Pipelines Read The Texture Index As A uint Directly After The Frame Push Constants
+        if(pipeline->bindless_set_index != UINT32_MAX && packet.texture_index != pushed_texture_index){
+            uint32_t texture_index = packet.texture_index;
+            pipeline->PushConstant(vk_command_buffer, sizeof(uint32_t), push_constant_size, &texture_index);
+            pushed_texture_index = packet.texture_index;
+            statistics.texture_index_push_count++;
+        }
+        if(packet.descriptor_set.vk_descriptor_set != VK_NULL_HANDLE &&
+           (packet.descriptor_set.vk_descriptor_set != bound_descriptor_set ||
+            packet.descriptor_set_binding != bound_descriptor_set_binding)){
+            pipeline->BindDescriptorSet(vk_command_buffer, packet.descriptor_set,
+                                        packet.descriptor_set_binding);
+            bound_descriptor_set         = packet.descriptor_set.vk_descriptor_set;
+            bound_descriptor_set_binding = packet.descriptor_set_binding;
+            statistics.descriptor_set_bind_count++;
+        }
+        if(packet.vertex_buffer != bound_vertex_buffer){
+            packet.vertex_buffer->BindAsVertexBuffer(vk_command_buffer, 0);
+            bound_vertex_buffer = packet.vertex_buffer;
+            statistics.buffer_bind_count++;
+        }
+        if(packet.index_buffer != bound_index_buffer){
+            packet.index_buffer->BindAsIndexBuffer(vk_command_buffer, 0);
+            bound_index_buffer = packet.index_buffer;
+            statistics.buffer_bind_count++;
+        }
+
+        vkCmdDrawIndexed(vk_command_buffer,
+                         packet.index_count, packet.instance_count,
+                         packet.first_index, packet.vertex_offset, packet.instance_offset);
+        statistics.draw_count++;
+        statistics.triangle_count += (uint64_t)(packet.index_count / 3) * packet.instance_count;
+    }
+    
+    static core::MetricCounter* draw_call_counter     = core::metrics.Counter("draw_calls");
+    static core::MetricCounter* triangle_counter      = core::metrics.Counter("triangles");
+    static core::MetricCounter* pipeline_bind_counter = core::metrics.Counter("pipeline_binds");
+    draw_call_counter->Add(statistics.draw_count);
+    triangle_counter->Add(statistics.triangle_count);
+    pipeline_bind_counter->Add(statistics.pipeline_bind_count);
+}
+
+void DrawQueue::Clear(){
+    packets_.clear();
+    entries_.clear();
+}
+}
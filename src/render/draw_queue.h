@@ -0,0 +1,68 @@
+#pragma once
+#include "render/pipeline.h"
+#include "render/buffer.h"
+#include "render/bindless.h"
+
+namespace render{
+// Sort Key Layout, Most Significant First:
+// | pass 4 | pipeline 12 | descriptor set 12 | vertex page 4 | index page 4 | mesh 12 | depth 16 |
+struct DrawKey{
+    uint8_t  pass;
+    uint16_t pipeline;
+    // Descriptor Set, Buffer Pages And Mesh Are Filled From The Packet On Submit So Draws Sharing
+    // A Set Or Geometry Sit Together; Set And Mesh Are Hashes, A Collision Only Costs A Rebind
+    uint16_t descriptor_set;
+    uint8_t  vertex_buffer_page;
+    uint8_t  index_buffer_page;
+    uint16_t mesh;
+    uint16_t depth;
+};
+uint64_t CreateSortKey(DrawKey key);
+uint16_t QuantizeDepth(float view_depth, float z_near, float z_far);
+
+struct DrawPacket{
+    Pipeline*     pipeline;
+    DescriptorSet descriptor_set;
+    uint32_t      descriptor_set_binding = 0;
+    uint32_t      texture_index = BINDLESS_INVALID_INDEX;
+
+    Buffer* vertex_buffer;
+    Buffer* index_buffer;
+    uint32_t vertex_buffer_page = 0;
+    uint32_t index_buffer_page  = 0;
+
+    uint32_t index_count;
+    uint32_t first_index;
+    int32_t  vertex_offset;
+    uint32_t instance_count  = 1;
+    uint32_t instance_offset = 0;
+};
+struct DrawQueueStatistics{
+    uint32_t draw_count;
+    uint32_t skipped_draw_count;
+    uint32_t fallback_draw_count;
+    uint32_t pipeline_bind_count;
+    uint32_t descriptor_set_bind_count;
+    uint32_t texture_index_push_count;
+    uint32_t buffer_bind_count;
+    uint64_t triangle_count;
+};
+class DrawQueue{
+public:
+    void Submit(DrawKey key, DrawPacket packet);
+    void Sort();
+    void Record(VkCommandBuffer vk_command_buffer, uint32_t push_constant_size, void* push_constant_data);
+    void Clear();
+
+    DrawQueueStatistics statistics{};
+
+private:
+    struct SortEntry{
+        uint64_t key;
+        uint32_t packet_index;
+    };
+    std::vector<DrawPacket> packets_;
+    std::vector<SortEntry>  entries_;
+    std::vector<SortEntry>  scratch_;
+};
+}
@@ -0,0 +1,379 @@
+#include "render/frame_graph.h"
+#include "render/memory_budget.h"
+
+#include <algorithm>
+
+namespace render{
+// Frame Graph Images Never Change Queues, So Their States Carry No Queue Family
+static ResourceState AccessState(FrameGraphAccess access){
+    switch(access){
+        case FRAME_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE:
+            return AccessState(RESOURCE_ACCESS_COLOR_ATTACHMENT_WRITE, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE:
+            return AccessState(RESOURCE_ACCESS_DEPTH_ATTACHMENT_WRITE, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_READ:
+            return AccessState(RESOURCE_ACCESS_DEPTH_ATTACHMENT_READ, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_SHADER_READ:
+            return AccessState(RESOURCE_ACCESS_SHADER_READ, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_TRANSFER_READ:
+            return AccessState(RESOURCE_ACCESS_TRANSFER_READ, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_TRANSFER_WRITE:
+            return AccessState(RESOURCE_ACCESS_TRANSFER_WRITE, VK_QUEUE_FAMILY_IGNORED);
+        case FRAME_GRAPH_ACCESS_PRESENT:
+        default:
+            return AccessState(RESOURCE_ACCESS_PRESENT, VK_QUEUE_FAMILY_IGNORED);
+    }
+}
+static bool IsWrite(FrameGraphAccess access){
+    return access == FRAME_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE ||
+           access == FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE ||
+           access == FRAME_GRAPH_ACCESS_TRANSFER_WRITE;
+}
+
+void FrameGraph::Initialize(){
+    statistics = {};
+    compiled_  = false;
+}
+void FrameGraph::Terminate(){
+    for(FrameGraphImage& image : images_){
+        if(image.transient && image.vk_image != VK_NULL_HANDLE){
+            render::image_view_cache.Release(image.vk_image);
+            vkDestroyImage(render::context.vk_device, image.vk_image, nullptr);
+        }
+    }
+    for(FrameGraphMemoryBucket& bucket : buckets_){
+        render::memory_budget.Untrack(MEMORY_CATEGORY_RENDER_TARGET, bucket.memory_requirements.size);
+        vmaFreeMemory(render::context.allocator, bucket.vma_allocation);
+    }
+    images_.clear();
+    passes_.clear();
+    buckets_.clear();
+    final_barriers_.clear();
+    final_barrier_resources_.clear();
+    compiled_ = false;
+}
+
+FrameGraphResource FrameGraph::CreateImage(const char* name, FrameGraphImageInfo info){
+    FrameGraphImage image{};
+    image.name = name;
+    image.info = info;
+    image.transient = true;
+    images_.emplace_back(image);
+    return (FrameGraphResource)(images_.size() - 1);
+}
+FrameGraphResource FrameGraph::ImportImage(const char* name, FrameGraphImageInfo info,
+                                           VkImageLayout initial_layout, VkImageLayout final_layout){
+    FrameGraphImage image{};
+    image.name = name;
+    image.info = info;
+    image.transient      = false;
+    image.initial_layout = initial_layout;
+    image.final_layout   = final_layout;
+    images_.emplace_back(image);
+    return (FrameGraphResource)(images_.size() - 1);
+}
+// Imported Handles May Change Every Frame, e.g. The Acquired Swapchain Image
+void FrameGraph::SetImportedImage(FrameGraphResource resource, VkImage vk_image, VkImageView vk_view){
+    images_[resource].vk_image = vk_image;
+    images_[resource].vk_view  = vk_view;
+}
+
+void FrameGraph::AddPass(const char* name, std::vector<FrameGraphUse> uses, FrameGraphExecuteFunction execute,
+                         bool side_effect){
+    if(compiled_){
+        throw std::runtime_error("FRAME GRAPH PASS ADDED AFTER COMPILE");
+    }
+    FrameGraphPass pass{};
+    pass.name        = name;
+    pass.uses        = std::move(uses);
+    pass.execute     = std::move(execute);
+    pass.side_effect = side_effect;
+    passes_.emplace_back(std::move(pass));
+}
+
+void FrameGraph::Compile(){
+    CullPasses();
+    ComputeLifetimes();
+    AllocateTransientImages();
+    BuildBarriers();
+    compiled_ = true;
+}
+
+// Walking Backwards From Exported Images And Side Effects, A Pass Survives Only If Something Consumes Its Writes
+void FrameGraph::CullPasses(){
+    std::vector<bool> needed(images_.size(), false);
+    for(uint32_t i = 0; i < images_.size(); i++){
+        needed[i] = !images_[i].transient && images_[i].final_layout != VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+    statistics.pass_count        = (uint32_t)passes_.size();
+    statistics.culled_pass_count = 0;
+    for(auto pass = passes_.rbegin(); pass != passes_.rend(); pass++){
+        bool live = pass->side_effect;
+        for(const FrameGraphUse& use : pass->uses){
+            live |= IsWrite(use.access) && needed[use.resource];
+        }
+        pass->culled = !live;
+        if(!live){
+            statistics.culled_pass_count++;
+            continue;
+        }
+        for(const FrameGraphUse& use : pass->uses){
+            if(!IsWrite(use.access)){
+                needed[use.resource] = true;
+            }
+        }
+    }
+}
+void FrameGraph::ComputeLifetimes(){
+    for(uint32_t pass_index = 0; pass_index < passes_.size(); pass_index++){
+        if(passes_[pass_index].culled){
+            continue;
+        }
+        for(const FrameGraphUse& use : passes_[pass_index].uses){
+            FrameGraphImage& image = images_[use.resource];
+            image.first_pass = std::min(image.first_pass, pass_index);
+            image.last_pass  = std::max(image.last_pass,  pass_index);
+        }
+    }
+}
+
+// Largest Images Are Placed First, Each Into The First Bucket Whose Occupants' Lifetimes It Doesn't Overlap
+void FrameGraph::AllocateTransientImages(){
+    std::vector<FrameGraphResource> transient_images{};
+    for(uint32_t i = 0; i < images_.size(); i++){
+        FrameGraphImage& image = images_[i];
+        if(!image.transient || image.first_pass == UINT32_MAX){
+            continue;
+        }
+        VkImageCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        create_info.flags = 0;
+        create_info.pNext = nullptr;
+        create_info.imageType = VK_IMAGE_TYPE_2D;
+        create_info.format    = image.info.format;
+        create_info.extent    = *(VkExtent3D*)&image.info.extent;
+        create_info.mipLevels   = 1;
+        create_info.arrayLayers = 1;
+        create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        create_info.tiling  = VK_IMAGE_TILING_OPTIMAL;
+        create_info.usage   = image.info.usage;
+        create_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkResult vk_result = vkCreateImage(render::context.vk_device, &create_info, nullptr, &image.vk_image);
+        if(vk_result != VK_SUCCESS){
+            throw std::runtime_error("FAILED TO CREATE FRAME GRAPH IMAGE");
+        }
+        vkGetImageMemoryRequirements(render::context.vk_device, image.vk_image, &image.memory_requirements);
+        transient_images.emplace_back(i);
+    }
+    std::sort(transient_images.begin(), transient_images.end(), [this](FrameGraphResource a, FrameGraphResource b){
+        return images_[a].memory_requirements.size > images_[b].memory_requirements.size;
+    });
+
+    statistics.transient_bytes = 0;
+    for(FrameGraphResource resource : transient_images){
+        FrameGraphImage& image = images_[resource];
+        statistics.transient_bytes += image.memory_requirements.size;
+        for(uint32_t bucket_index = 0; bucket_index < buckets_.size(); bucket_index++){
+            FrameGraphMemoryBucket& bucket = buckets_[bucket_index];
+            if((bucket.memory_requirements.memoryTypeBits & image.memory_requirements.memoryTypeBits) == 0){
+                continue;
+            }
+            bool overlaps = std::any_of(bucket.images.begin(), bucket.images.end(), [this, &image](FrameGraphResource other){
+                return images_[other].first_pass <= image.last_pass && image.first_pass <= images_[other].last_pass;
+            });
+            if(!overlaps){
+                image.memory_bucket = bucket_index;
+                break;
+            }
+        }
+        if(image.memory_bucket == UINT32_MAX){
+            image.memory_bucket = (uint32_t)buckets_.size();
+            FrameGraphMemoryBucket bucket{};
+            bucket.memory_requirements.memoryTypeBits = image.memory_requirements.memoryTypeBits;
+            bucket.last_state = { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, false };
+            buckets_.emplace_back(bucket);
+        }
+        FrameGraphMemoryBucket& bucket = buckets_[image.memory_bucket];
+        bucket.images.emplace_back(resource);
+        bucket.memory_requirements.size      = std::max(bucket.memory_requirements.size, image.memory_requirements.size);
+        bucket.memory_requirements.alignment = std::max(bucket.memory_requirements.alignment, image.memory_requirements.alignment);
+        bucket.memory_requirements.memoryTypeBits &= image.memory_requirements.memoryTypeBits;
+    }
+
+    statistics.aliased_transient_bytes = 0;
+    for(FrameGraphMemoryBucket& bucket : buckets_){
+        VmaAllocationCreateInfo allocation_create_info{};
+        allocation_create_info.requiredFlags  = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        allocation_create_info.memoryTypeBits = bucket.memory_requirements.memoryTypeBits;
+        VkResult vk_result = vmaAllocateMemory(render::context.allocator, &bucket.memory_requirements,
+                                               &allocation_create_info, &bucket.vma_allocation, nullptr);
+        if(vk_result != VK_SUCCESS){
+            throw std::runtime_error("FAILED TO ALLOCATE FRAME GRAPH MEMORY");
+        }
+        statistics.aliased_transient_bytes += bucket.memory_requirements.size;
+        render::memory_budget.Track(MEMORY_CATEGORY_RENDER_TARGET, bucket.memory_requirements.size);
+        for(FrameGraphResource resource : bucket.images){
+            FrameGraphImage& image = images_[resource];
+            vmaBindImageMemory(render::context.allocator, bucket.vma_allocation, image.vk_image);
+
+            ImageViewInfo view_info{};
+            view_info.vk_image    = image.vk_image;
+            view_info.format      = image.info.format;
+            view_info.aspect_mask = image.info.aspect_mask;
+            image.vk_view = render::image_view_cache.Get(view_info);
+        }
+    }
+}
+
+bool FrameGraph::AppendBarrier(FrameGraphResource resource, ResourceState* state,
+                               ResourceState target, VkImageMemoryBarrier* barrier){
+    // Reads Following Reads In The Same Layout Need No Barrier, Later Writes Wait On All Of Them
+    if(state->layout == target.layout && !state->written && !target.written){
+        state->stage_mask  |= target.stage_mask;
+        state->access_mask |= target.access_mask;
+        return false;
+    }
+    *barrier = {};
+    barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier->pNext = nullptr;
+    barrier->srcAccessMask = state->written ? state->access_mask : 0;
+    barrier->dstAccessMask = target.access_mask;
+    barrier->oldLayout = state->layout;
+    barrier->newLayout = target.layout;
+    barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier->subresourceRange.aspectMask     = images_[resource].info.aspect_mask;
+    barrier->subresourceRange.baseMipLevel   = 0;
+    barrier->subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+    barrier->subresourceRange.baseArrayLayer = 0;
+    barrier->subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+    return true;
+}
+
+// Barriers Are Simulated Once At Compile Time, Since Every Frame Replays The Same Sequence Of Accesses
+void FrameGraph::BuildBarriers(){
+    for(FrameGraphImage& image : images_){
+        if(image.transient){
+            image.state = { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, VK_QUEUE_FAMILY_IGNORED, false };
+        }
+        else{
+            image.state = { image.initial_layout, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT,
+                            VK_QUEUE_FAMILY_IGNORED, true };
+        }
+    }
+    statistics.barrier_count       = 0;
+    statistics.barrier_batch_count = 0;
+    for(uint32_t pass_index = 0; pass_index < passes_.size(); pass_index++){
+        FrameGraphPass& pass = passes_[pass_index];
+        if(pass.culled){
+            continue;
+        }
+        // Uses Of One Image Within A Pass Are Merged Into A Single Target State
+        std::vector<std::pair<FrameGraphResource, ResourceState>> targets{};
+        for(const FrameGraphUse& use : pass.uses){
+            ResourceState access_state = AccessState(use.access);
+            auto target = std::find_if(targets.begin(), targets.end(), [&use](const auto& target){
+                return target.first == use.resource;
+            });
+            if(target == targets.end()){
+                targets.emplace_back(use.resource, access_state);
+                continue;
+            }
+            if(target->second.layout != access_state.layout){
+                throw std::runtime_error("FRAME GRAPH PASS USES ONE IMAGE IN TWO LAYOUTS");
+            }
+            target->second.stage_mask  |= access_state.stage_mask;
+            target->second.access_mask |= access_state.access_mask;
+            target->second.written     |= access_state.written;
+        }
+
+        for(auto& [resource, target] : targets){
+            FrameGraphImage& image = images_[resource];
+            // Aliased Memory Is Taken Over From The Bucket's Previous Occupant, Contents Discarded
+            if(image.transient && image.first_pass == pass_index){
+                const ResourceState& previous = buckets_[image.memory_bucket].last_state;
+                image.state = { VK_IMAGE_LAYOUT_UNDEFINED, previous.stage_mask, previous.access_mask,
+                                VK_QUEUE_FAMILY_IGNORED, true };
+            }
+            VkPipelineStageFlags source_stage_mask = image.state.stage_mask;
+            VkImageMemoryBarrier barrier;
+            if(AppendBarrier(resource, &image.state, target, &barrier)){
+                pass.barriers.emplace_back(barrier);
+                pass.barrier_resources.emplace_back(resource);
+                pass.barrier_source_stage_mask      |= source_stage_mask;
+                pass.barrier_destination_stage_mask |= target.stage_mask;
+                image.state = target;
+            }
+            if(image.transient && image.last_pass == pass_index){
+                buckets_[image.memory_bucket].last_state = image.state;
+            }
+        }
+        if(!pass.barriers.empty()){
+            statistics.barrier_count += (uint32_t)pass.barriers.size();
+            statistics.barrier_batch_count++;
+        }
+    }
+
+    final_source_stage_mask_ = 0;
+    for(uint32_t resource = 0; resource < images_.size(); resource++){
+        FrameGraphImage& image = images_[resource];
+        if(image.transient || image.final_layout == VK_IMAGE_LAYOUT_UNDEFINED ||
+           image.state.layout == image.final_layout){
+            continue;
+        }
+        ResourceState target = { image.final_layout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                                  VK_QUEUE_FAMILY_IGNORED, false };
+        VkPipelineStageFlags source_stage_mask = image.state.stage_mask;
+        VkImageMemoryBarrier barrier;
+        if(AppendBarrier(resource, &image.state, target, &barrier)){
+            final_barriers_.emplace_back(barrier);
+            final_barrier_resources_.emplace_back(resource);
+            final_source_stage_mask_ |= source_stage_mask;
+        }
+    }
+    if(!final_barriers_.empty()){
+        statistics.barrier_count += (uint32_t)final_barriers_.size();
+        statistics.barrier_batch_count++;
+    }
+}
+
+void FrameGraph::RecordBarriers(VkCommandBuffer vk_command_buffer, std::vector<VkImageMemoryBarrier>& barriers,
+                                const std::vector<FrameGraphResource>& barrier_resources,
+                                VkPipelineStageFlags source_stage_mask, VkPipelineStageFlags destination_stage_mask){
+    if(barriers.empty()){
+        return;
+    }
+    for(size_t i = 0; i < barriers.size(); i++){
+        barriers[i].image = images_[barrier_resources[i]].vk_image;
+    }
+    vkCmdPipelineBarrier(vk_command_buffer, source_stage_mask, destination_stage_mask, 0,
+                         0, nullptr, 0, nullptr, (uint32_t)barriers.size(), barriers.data());
+    resource_barrier_statistics.barrier_count += (uint32_t)barriers.size();
+    resource_barrier_statistics.barrier_batch_count++;
+}
+void FrameGraph::Execute(VkCommandBuffer vk_command_buffer){
+    if(!compiled_){
+        throw std::runtime_error("FRAME GRAPH EXECUTED BEFORE COMPILE");
+    }
+    for(FrameGraphPass& pass : passes_){
+        if(pass.culled){
+            continue;
+        }
+        RecordBarriers(vk_command_buffer, pass.barriers, pass.barrier_resources,
+                       pass.barrier_source_stage_mask, pass.barrier_destination_stage_mask);
+        if(pass.execute){
+            pass.execute(vk_command_buffer, this);
+        }
+    }
+    RecordBarriers(vk_command_buffer, final_barriers_, final_barrier_resources_,
+                   final_source_stage_mask_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+VkImage FrameGraph::GetImage(FrameGraphResource resource){
+    return images_[resource].vk_image;
+}
+VkImageView FrameGraph::GetView(FrameGraphResource resource){
+    return images_[resource].vk_view;
+}
+}
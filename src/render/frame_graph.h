@@ -0,0 +1,124 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "render/context.h"
+#include "render/texture.h"
+#include "render/resource_state.h"
+
+namespace render{
+typedef uint32_t FrameGraphResource;
+
+enum FrameGraphAccess{
+    FRAME_GRAPH_ACCESS_COLOR_ATTACHMENT_WRITE,
+    FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_WRITE,
+    FRAME_GRAPH_ACCESS_DEPTH_ATTACHMENT_READ,
+    FRAME_GRAPH_ACCESS_SHADER_READ,
+    FRAME_GRAPH_ACCESS_TRANSFER_READ,
+    FRAME_GRAPH_ACCESS_TRANSFER_WRITE,
+    FRAME_GRAPH_ACCESS_PRESENT,
+};
+struct FrameGraphUse{
+    FrameGraphResource resource;
+    FrameGraphAccess   access;
+};
+struct FrameGraphImageInfo{
+    ImageExtent        extent;
+    VkFormat           format;
+    VkImageUsageFlags  usage;
+    VkImageAspectFlags aspect_mask = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+class FrameGraph;
+typedef std::function<void(VkCommandBuffer, FrameGraph*)> FrameGraphExecuteFunction;
+
+struct FrameGraphImage{
+    std::string         name;
+    FrameGraphImageInfo info;
+    bool transient = true;
+
+    // Imported Images Keep Their Contents Across Frames And Are Left In final_layout
+    VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout final_layout   = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkImage     vk_image = VK_NULL_HANDLE;
+    VkImageView vk_view  = VK_NULL_HANDLE;
+    VkMemoryRequirements memory_requirements{};
+    uint32_t memory_bucket = UINT32_MAX;
+
+    uint32_t first_pass = UINT32_MAX;
+    uint32_t last_pass  = 0;
+    ResourceState state{};
+};
+struct FrameGraphPass{
+    std::string name;
+    std::vector<FrameGraphUse> uses;
+    FrameGraphExecuteFunction execute;
+    bool side_effect = false;
+    bool culled      = false;
+
+    std::vector<VkImageMemoryBarrier> barriers;
+    std::vector<FrameGraphResource>   barrier_resources;
+    VkPipelineStageFlags barrier_source_stage_mask      = 0;
+    VkPipelineStageFlags barrier_destination_stage_mask = 0;
+};
+// Transient Images Whose Lifetimes Never Overlap Share One Allocation
+struct FrameGraphMemoryBucket{
+    VmaAllocation vma_allocation = VK_NULL_HANDLE;
+    VkMemoryRequirements memory_requirements{};
+    std::vector<FrameGraphResource> images;
+    ResourceState last_state{};
+};
+struct FrameGraphStatistics{
+    uint32_t pass_count;
+    uint32_t culled_pass_count;
+    uint32_t barrier_count;
+    uint32_t barrier_batch_count;
+    VkDeviceSize transient_bytes;
+    VkDeviceSize aliased_transient_bytes;
+};
+
+// Passes Declare The Images They Read And Write; Compile Culls Passes Whose Results Are Never Consumed,
+// Aliases Transient Memory And Precomputes One Batched Barrier Per Pass, Execute Replays It Every Frame
+class FrameGraph{
+public:
+    void Initialize();
+    void Terminate();
+
+    FrameGraphResource CreateImage(const char* name, FrameGraphImageInfo info);
+    FrameGraphResource ImportImage(const char* name, FrameGraphImageInfo info,
+                                   VkImageLayout initial_layout, VkImageLayout final_layout);
+    void SetImportedImage(FrameGraphResource resource, VkImage vk_image, VkImageView vk_view);
+
+    void AddPass(const char* name, std::vector<FrameGraphUse> uses, FrameGraphExecuteFunction execute,
+                 bool side_effect = false);
+
+    void Compile();
+    void Execute(VkCommandBuffer vk_command_buffer);
+
+    VkImage     GetImage(FrameGraphResource resource);
+    VkImageView GetView (FrameGraphResource resource);
+
+    FrameGraphStatistics statistics{};
+
+private:
+    void CullPasses();
+    void ComputeLifetimes();
+    void AllocateTransientImages();
+    void BuildBarriers();
+    bool AppendBarrier(FrameGraphResource resource, ResourceState* state,
+                       ResourceState target, VkImageMemoryBarrier* barrier);
+    void RecordBarriers(VkCommandBuffer vk_command_buffer, std::vector<VkImageMemoryBarrier>& barriers,
+                        const std::vector<FrameGraphResource>& barrier_resources,
+                        VkPipelineStageFlags source_stage_mask, VkPipelineStageFlags destination_stage_mask);
+
+    std::vector<FrameGraphImage>        images_;
+    std::vector<FrameGraphPass>         passes_;
+    std::vector<FrameGraphMemoryBucket> buckets_;
+    std::vector<VkImageMemoryBarrier>   final_barriers_;
+    std::vector<FrameGraphResource>     final_barrier_resources_;
+    VkPipelineStageFlags final_source_stage_mask_ = 0;
+    bool compiled_ = false;
+};
+}
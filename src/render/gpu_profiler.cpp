@@ -0,0 +1,148 @@
+#include "render/gpu_profiler.h"
+
+namespace render{
+GpuProfiler gpu_profiler{};
+thread_local uint32_t GpuProfiler::recording_frame_ = 0;
+
+void GpuProfiler::Initialize(uint32_t frame_count, uint32_t zones_per_frame){
+    if(render::context.timestamp_valid_bits == 0 || !render::context.host_query_reset_supported){
+        printf("GPU PROFILER: TIMESTAMPS NOT SUPPORTED\n");
+        return;
+    }
+    frame_count_     = frame_count;
+    zones_per_frame_ = zones_per_frame;
+    // The Extra Range Past The Frames Holds Upload Batch Zones
+    frames_ = std::vector<GpuProfilerFrame>(frame_count + 1);
+    for(GpuProfilerFrame& frame : frames_){
+        frame.zone_names.resize(zones_per_frame);
+    }
+    results_.resize(zones_per_frame * 2 * 2);
+    
+    VkQueryPoolCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    create_info.pNext = nullptr;
+    create_info.flags = 0;
+    create_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    create_info.queryCount = (frame_count + 1) * zones_per_frame * 2;
+    VkResult vk_result = vkCreateQueryPool(render::context.vk_device, &create_info, nullptr, &vk_query_pool_);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE TIMESTAMP QUERY POOL");
+    }
+    vkResetQueryPool(render::context.vk_device, vk_query_pool_, 0, create_info.queryCount);
+    
+    if(core::profiler.IsEnabled()){
+        trace_track_ = core::profiler.RegisterTrack("GPU Graphics Queue");
+    }
+}
+void GpuProfiler::Terminate(){
+    if(!IsEnabled()){
+        return;
+    }
+    vkDestroyQueryPool(render::context.vk_device, vk_query_pool_, nullptr);
+    vk_query_pool_ = VK_NULL_HANDLE;
+    frames_.clear();
+    timings.clear();
+    upload_timings.clear();
+}
+bool GpuProfiler::IsEnabled(){
+    return vk_query_pool_ != VK_NULL_HANDLE;
+}
+
+void GpuProfiler::BeginFrame(uint32_t frame){
+    if(!IsEnabled()){
+        return;
+    }
+    frame %= frame_count_;
+    Resolve(frame, &timings);
+    frames_[frame].cpu_start_nanoseconds = core::profiler.IsEnabled() ? core::profiler.Now() : 0;
+    SetRecordingFrame(frame);
+}
+void GpuProfiler::SetRecordingFrame(uint32_t frame){
+    recording_frame_ = frame % std::max(frame_count_, 1u);
+}
+
+uint32_t GpuProfiler::BeginZone(VkCommandBuffer vk_command_buffer, const char* name){
+    if(!IsEnabled()){
+        return UINT32_MAX;
+    }
+    return BeginZone(vk_command_buffer, name, recording_frame_);
+}
+uint32_t GpuProfiler::BeginUploadZone(VkCommandBuffer vk_command_buffer, const char* name){
+    if(!IsEnabled()){
+        return UINT32_MAX;
+    }
+    if(frames_[frame_count_].query_count.load() == 0){
+        frames_[frame_count_].cpu_start_nanoseconds = core::profiler.IsEnabled() ? core::profiler.Now() : 0;
+    }
+    return BeginZone(vk_command_buffer, name, frame_count_);
+}
+uint32_t GpuProfiler::BeginZone(VkCommandBuffer vk_command_buffer, const char* name, uint32_t frame){
+    GpuProfilerFrame& profiler_frame = frames_[frame];
+    uint32_t zone = profiler_frame.query_count.fetch_add(1, std::memory_order_relaxed);
+    if(zone >= zones_per_frame_){
+        return UINT32_MAX;
+    }
+    profiler_frame.zone_names[zone] = name;
+    const uint32_t query = (frame * zones_per_frame_ + zone) * 2;
+    vkCmdWriteTimestamp(vk_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vk_query_pool_, query);
+    return frame * zones_per_frame_ + zone;
+}
+void GpuProfiler::EndZone(VkCommandBuffer vk_command_buffer, uint32_t zone){
+    if(zone == UINT32_MAX){
+        return;
+    }
+    vkCmdWriteTimestamp(vk_command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vk_query_pool_, zone * 2 + 1);
+}
+
+void GpuProfiler::ResolveUploads(){
+    if(!IsEnabled()){
+        return;
+    }
+    Resolve(frame_count_, &upload_timings);
+}
+
+// Zones Whose Results Are Not Yet Available Are Dropped Rather Than Waited On
+void GpuProfiler::Resolve(uint32_t frame, std::vector<GpuTiming>* resolved_timings){
+    GpuProfilerFrame& profiler_frame = frames_[frame];
+    const uint32_t zone_count = std::min(profiler_frame.query_count.load(), zones_per_frame_);
+    const uint32_t first_query = frame * zones_per_frame_ * 2;
+    resolved_timings->clear();
+    if(zone_count == 0){
+        return;
+    }
+    
+    vkGetQueryPoolResults(render::context.vk_device, vk_query_pool_, first_query, zone_count * 2,
+                          zone_count * 2 * 2 * sizeof(uint64_t), results_.data(), 2 * sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    
+    const uint64_t mask = render::context.timestamp_valid_bits >= 64 ?
+    UINT64_MAX : (1ull << render::context.timestamp_valid_bits) - 1;
+    const double nanoseconds_per_tick = render::context.timestamp_period;
+    uint64_t frame_begin_ticks = UINT64_MAX;
+    for(uint32_t zone = 0; zone < zone_count; zone++){
+        if(results_[zone * 4 + 1] != 0){
+            frame_begin_ticks = std::min(frame_begin_ticks, results_[zone * 4] & mask);
+        }
+    }
+    for(uint32_t zone = 0; zone < zone_count; zone++){
+        const uint64_t* begin = &results_[zone * 4];
+        const uint64_t* end   = &results_[zone * 4 + 2];
+        if(begin[1] == 0 || end[1] == 0){
+            continue;
+        }
+        const uint64_t ticks = ((end[0] & mask) - (begin[0] & mask)) & mask;
+        const uint64_t duration_nanoseconds = (uint64_t)(ticks * nanoseconds_per_tick);
+        resolved_timings->push_back({ profiler_frame.zone_names[zone], duration_nanoseconds / 1000000.0f });
+        
+        // Without Calibrated Timestamps The Track Is Anchored At The Frame's CPU Start
+        if(trace_track_ != nullptr){
+            const uint64_t offset_nanoseconds = (uint64_t)((((begin[0] & mask) - frame_begin_ticks) & mask) * nanoseconds_per_tick);
+            core::profiler.Record(trace_track_, profiler_frame.zone_names[zone],
+                                  profiler_frame.cpu_start_nanoseconds + offset_nanoseconds, duration_nanoseconds);
+        }
+    }
+    
+    vkResetQueryPool(render::context.vk_device, vk_query_pool_, first_query, zone_count * 2);
+    profiler_frame.query_count = 0;
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "render/context.h"
+#include "profiler.h"
+
+namespace render{
+struct GpuTiming{
+    const char* name;
+    float milliseconds;
+};
+struct GpuProfilerFrame{
+    std::atomic<uint32_t> query_count = 0;
+    std::vector<const char*> zone_names;
+    // CPU Time The Frame Began, GPU Zones Are Placed On The Trace Relative To It
+    uint64_t cpu_start_nanoseconds = 0;
+};
+
+// Brackets Passes With vkCmdWriteTimestamp Into A Per-Frame Range Of One Query Pool;
+// A Frame's Range Is Read Back Without Waiting Once Its Fence Has Signaled, Then Reset From The Host.
+// Upload Batches Complete On Their Own Fence, So They Get A Range After The Frames'
+class GpuProfiler{
+public:
+    void Initialize(uint32_t frame_count, uint32_t zones_per_frame = 128);
+    void Terminate();
+    bool IsEnabled();
+    
+    // Called On The Main Thread After The Frame's Fence Wait, Before Anything Records Into The Frame
+    void BeginFrame(uint32_t frame);
+    // Zones Recorded On This Thread Go Into The Given Frame's Range
+    void SetRecordingFrame(uint32_t frame);
+    
+    uint32_t BeginZone(VkCommandBuffer vk_command_buffer, const char* name);
+    void     EndZone  (VkCommandBuffer vk_command_buffer, uint32_t zone);
+    
+    uint32_t BeginUploadZone(VkCommandBuffer vk_command_buffer, const char* name);
+    // Called Once The Upload Batch's Fence Has Signaled, Before The Next Batch Records
+    void     ResolveUploads();
+    
+    // Timings Of The Last Frame Read Back By BeginFrame
+    std::vector<GpuTiming> timings;
+    // Timings Of The Last Upload Batch Read Back By ResolveUploads
+    std::vector<GpuTiming> upload_timings;
+    
+private:
+    uint32_t BeginZone(VkCommandBuffer vk_command_buffer, const char* name, uint32_t frame);
+    void Resolve(uint32_t frame, std::vector<GpuTiming>* resolved_timings);
+    
+    VkQueryPool vk_query_pool_ = VK_NULL_HANDLE;
+    uint32_t frame_count_ = 0;
+    uint32_t zones_per_frame_ = 0;
+    std::vector<GpuProfilerFrame> frames_;
+    std::vector<uint64_t> results_;
+    core::ProfileThreadBuffer* trace_track_ = nullptr;
+    static thread_local uint32_t recording_frame_;
+};
+extern GpuProfiler gpu_profiler;
+
+class GpuZone{
+public:
+    GpuZone(VkCommandBuffer vk_command_buffer, const char* name) : vk_command_buffer_(vk_command_buffer){
+        zone_ = gpu_profiler.BeginZone(vk_command_buffer, name);
+    }
+    ~GpuZone(){
+        gpu_profiler.EndZone(vk_command_buffer_, zone_);
+    }
+private:
+    VkCommandBuffer vk_command_buffer_;
+    uint32_t zone_;
+};
+}
+
+#ifndef ENGINE_DISABLE_PROFILING
+#define PROFILE_GPU_ZONE(command_buffer, name) \
+render::GpuZone PROFILE_CONCATENATE(gpu_zone_, __LINE__)(command_buffer, name)
+#else
+#define PROFILE_GPU_ZONE(command_buffer, name)
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace render{
+// FNV-1a, Used To Key Caches Of Vulkan Objects
+constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED){
+    const uint8_t* bytes = (const uint8_t*)data;
+    for(size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+template<typename T>
+inline uint64_t HashValue(const T& value, uint64_t hash = HASH_SEED){
+    return HashBytes(&value, sizeof(T), hash);
+}
+
+// Canonical Form Of Some Object State, Compared Word For Word So Collisions Of The Key's Own Hash
+// Never Alias Objects; Words That Are Themselves Hashes, Like Shader Code Hashes, Still Can
+struct StateKey{
+    std::vector<uint64_t> words;
+    uint64_t hash = HASH_SEED;
+    
+    void Finalize(){ hash = HashBytes(words.data(), words.size() * sizeof(uint64_t)); }
+    bool operator==(const StateKey& other) const { return hash == other.hash && words == other.words; }
+};
+struct StateKeyHash{
+    size_t operator()(const StateKey& key) const { return (size_t)key.hash; }
+};
+}
@@ -0,0 +1,148 @@
+#include "render/memory_budget.h"
+#include "metrics.h"
+
+namespace render{
+const char* MemoryCategoryName(MemoryCategory category){
+    switch(category){
+        case MEMORY_CATEGORY_MESH:          return "mesh";
+        case MEMORY_CATEGORY_TEXTURE:       return "texture";
+        case MEMORY_CATEGORY_STAGING:       return "staging";
+        case MEMORY_CATEGORY_RENDER_TARGET: return "render_target";
+        default:                            return "other";
+    }
+}
+
+MemoryBudget memory_budget{};
+void MemoryBudget::Initialize(MemoryBudgetInfo info){
+    info_ = info;
+    statistics = {};
+}
+void MemoryBudget::Terminate(){
+    std::lock_guard<std::mutex> lock(evictable_mutex_);
+    lru_.clear();
+    evictable_map_.clear();
+}
+
+void MemoryBudget::Track(MemoryCategory category, VkDeviceSize size){
+    category_usage_[category].fetch_add(size, std::memory_order_relaxed);
+}
+void MemoryBudget::Untrack(MemoryCategory category, VkDeviceSize size){
+    category_usage_[category].fetch_sub(size, std::memory_order_relaxed);
+}
+VkDeviceSize MemoryBudget::GetUsage(MemoryCategory category){
+    return category_usage_[category].load(std::memory_order_relaxed);
+}
+
+// Sums Device Local Heaps, Which Are The Ones That Page Out Of VRAM When Oversubscribed
+void MemoryBudget::QueryDeviceBudget(VkDeviceSize* usage, VkDeviceSize* budget){
+    const VkPhysicalDeviceMemoryProperties* memory_properties;
+    vmaGetMemoryProperties(render::context.allocator, &memory_properties);
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(render::context.allocator, budgets);
+    
+    *usage  = 0;
+    *budget = 0;
+    for(uint32_t i = 0; i < memory_properties->memoryHeapCount; i++){
+        if(memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT){
+            *usage  += budgets[i].usage;
+            *budget += budgets[i].budget;
+        }
+    }
+}
+bool MemoryBudget::Fits(MemoryCategory category, VkDeviceSize size){
+    VkDeviceSize device_usage, device_budget;
+    QueryDeviceBudget(&device_usage, &device_budget);
+    const VkDeviceSize limit = info_.category_limits[category];
+    if(limit != 0 && GetUsage(category) + size > limit){
+        return false;
+    }
+    return device_usage + size <= (VkDeviceSize)(device_budget * info_.device_budget_fraction);
+}
+
+EvictableHandle MemoryBudget::RegisterEvictable(MemoryCategory category, VkDeviceSize size, EvictionCallback evict){
+    std::lock_guard<std::mutex> lock(evictable_mutex_);
+    EvictableHandle handle = next_handle_++;
+    lru_.push_back({ handle, category, size, frame_.load(std::memory_order_relaxed), std::move(evict) });
+    evictable_map_.emplace(handle, std::prev(lru_.end()));
+    return handle;
+}
+void MemoryBudget::UnregisterEvictable(EvictableHandle handle){
+    std::lock_guard<std::mutex> lock(evictable_mutex_);
+    auto iterator = evictable_map_.find(handle);
+    if(iterator == evictable_map_.end()){
+        return;
+    }
+    lru_.erase(iterator->second);
+    evictable_map_.erase(iterator);
+}
+void MemoryBudget::Touch(EvictableHandle handle){
+    std::lock_guard<std::mutex> lock(evictable_mutex_);
+    auto iterator = evictable_map_.find(handle);
+    if(iterator == evictable_map_.end()){
+        return;
+    }
+    iterator->second->last_used_frame = frame_.load(std::memory_order_relaxed);
+    lru_.splice(lru_.end(), lru_, iterator->second);
+}
+
+void MemoryBudget::BeginFrame(uint64_t frame){
+    frame_ = frame;
+    vmaSetCurrentFrameIndex(render::context.allocator, (uint32_t)frame);
+    
+    VkDeviceSize device_usage, device_budget;
+    QueryDeviceBudget(&device_usage, &device_budget);
+    statistics.device_local_usage  = device_usage;
+    statistics.device_local_budget = device_budget;
+    
+    // Callbacks Free Memory Through Untrack, Device Usage Is Only Re-Queried Next Frame So Evictions Are Subtracted Here
+    std::vector<EvictionCallback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(evictable_mutex_);
+        VkDeviceSize pending_category_bytes[MEMORY_CATEGORY_COUNT] = {};
+        VkDeviceSize pending_device_bytes = 0;
+        auto over_limit = [&](MemoryCategory category){
+            const VkDeviceSize limit = info_.category_limits[category];
+            const VkDeviceSize usage = GetUsage(category);
+            if(limit != 0 && usage - std::min(usage, pending_category_bytes[category]) > limit){
+                return true;
+            }
+            return device_usage - std::min(device_usage, pending_device_bytes) >
+                   (VkDeviceSize)(device_budget * info_.device_budget_fraction);
+        };
+        for(auto iterator = lru_.begin(); iterator != lru_.end();){
+            if(iterator->last_used_frame + info_.frames_in_flight > frame){
+                break;
+            }
+            if(!over_limit(iterator->category)){
+                ++iterator;
+                continue;
+            }
+            pending_category_bytes[iterator->category] += iterator->size;
+            pending_device_bytes += iterator->size;
+            statistics.evicted_count++;
+            statistics.evicted_bytes += iterator->size;
+            callbacks.emplace_back(std::move(iterator->evict));
+            evictable_map_.erase(iterator->handle);
+            iterator = lru_.erase(iterator);
+        }
+    }
+    for(EvictionCallback& callback : callbacks){
+        callback();
+    }
+    
+    static core::MetricGauge* usage_gauge  = core::metrics.Gauge("vram_device_local_usage");
+    static core::MetricGauge* budget_gauge = core::metrics.Gauge("vram_device_local_budget");
+    static core::MetricCounter* eviction_counter = core::metrics.Counter("vram_evictions");
+    static core::MetricGauge* category_gauges[MEMORY_CATEGORY_COUNT] = {
+        core::metrics.Gauge("vram_other"),   core::metrics.Gauge("vram_mesh"),
+        core::metrics.Gauge("vram_texture"), core::metrics.Gauge("vram_staging"),
+        core::metrics.Gauge("vram_render_target"),
+    };
+    usage_gauge->Set((double)device_usage);
+    budget_gauge->Set((double)device_budget);
+    eviction_counter->Add(callbacks.size());
+    for(uint32_t i = 0; i < MEMORY_CATEGORY_COUNT; i++){
+        category_gauges[i]->Set((double)GetUsage((MemoryCategory)i));
+    }
+}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "render/context.h"
+
+namespace render{
+enum MemoryCategory{
+    MEMORY_CATEGORY_OTHER,
+    MEMORY_CATEGORY_MESH,
+    MEMORY_CATEGORY_TEXTURE,
+    MEMORY_CATEGORY_STAGING,
+    MEMORY_CATEGORY_RENDER_TARGET,
+    MEMORY_CATEGORY_COUNT,
+};
+const char* MemoryCategoryName(MemoryCategory category);
+
+struct MemoryBudgetInfo{
+    // Zero Leaves A Category Unlimited
+    VkDeviceSize category_limits[MEMORY_CATEGORY_COUNT] = {};
+    // Share Of The Driver Reported Device Local Budget Used Before Evicting
+    float device_budget_fraction = 0.9f;
+    // Resources Used Within This Many Frames May Still Be Read By The GPU And Are Never Evicted
+    uint32_t frames_in_flight = 2;
+};
+
+typedef uint32_t EvictableHandle;
+const EvictableHandle EVICTABLE_INVALID_HANDLE = UINT32_MAX;
+typedef std::function<void()> EvictionCallback;
+
+struct EvictableResource{
+    EvictableHandle  handle;
+    MemoryCategory   category;
+    VkDeviceSize     size;
+    uint64_t         last_used_frame;
+    EvictionCallback evict;
+};
+struct MemoryBudgetStatistics{
+    VkDeviceSize device_local_usage;
+    VkDeviceSize device_local_budget;
+    uint32_t evicted_count;
+    VkDeviceSize evicted_bytes;
+};
+
+// Per Category Accounting On Top Of VMA Heap Budgets; Streaming Systems Register Evictable Resources,
+// Touch Them When Drawn, And BeginFrame Evicts The Least Recently Used Ones While Over A Limit
+class MemoryBudget{
+public:
+    void Initialize(MemoryBudgetInfo info = {});
+    void Terminate();
+    
+    void Track  (MemoryCategory category, VkDeviceSize size);
+    void Untrack(MemoryCategory category, VkDeviceSize size);
+    VkDeviceSize GetUsage(MemoryCategory category);
+    // Whether An Allocation Fits Its Category Limit And The Device Budget Without Evicting
+    bool Fits(MemoryCategory category, VkDeviceSize size);
+    
+    EvictableHandle RegisterEvictable(MemoryCategory category, VkDeviceSize size, EvictionCallback evict);
+    void UnregisterEvictable(EvictableHandle handle);
+    void Touch(EvictableHandle handle);
+    
+    // Called On The Main Thread After The Frame's Fence Wait
+    void BeginFrame(uint64_t frame);
+    
+    MemoryBudgetStatistics statistics{};
+    
+private:
+    void QueryDeviceBudget(VkDeviceSize* usage, VkDeviceSize* budget);
+    
+    MemoryBudgetInfo info_{};
+    std::atomic<VkDeviceSize> category_usage_[MEMORY_CATEGORY_COUNT] = {};
+    std::atomic<uint64_t> frame_ = 0;
+    
+    std::mutex evictable_mutex_{};
+    // Front Is Least Recently Used
+    std::list<EvictableResource> lru_{};
+    std::unordered_map<EvictableHandle, std::list<EvictableResource>::iterator> evictable_map_{};
+    EvictableHandle next_handle_ = 0;
+};
+extern MemoryBudget memory_budget;
+}
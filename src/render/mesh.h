@@ -2,6 +2,7 @@
 
 #include "render/pipeline.h"
 #include "render/buffer.h"
+#include "render/draw_queue.h"
 
 #define MESH_VERTEX_STRUCT struct
 
@@ -81,17 +82,42 @@ public:
     void Initialize(uint32_t vertex_count, uint32_t index_count){
         vertex_allocation = gpu_buffer.Allocate<T>(vertex_count);
         index_allocation  = gpu_buffer.Allocate<uint32_t>(index_count);
+        vertex_handle = gpu_buffer.Track(vertex_allocation);
+        index_handle  = gpu_buffer.Track(index_allocation);
     }
     void Terminate(){
-        gpu_buffer.Free(vertex_allocation);
-        gpu_buffer.Free(index_allocation);
+        gpu_buffer.FreeTracked(vertex_handle);
+        gpu_buffer.FreeTracked(index_handle);
+    }
+    // The Defragmenter May Have Moved Either Range Since The Last Draw
+    void Relocate(){
+        vertex_allocation = gpu_buffer.Resolve(vertex_handle, vertex_allocation);
+        index_allocation  = gpu_buffer.Resolve(index_handle,  index_allocation);
     }
     
     void Draw(VkCommandBuffer vk_command_buffer, uint32_t instance_count, uint32_t instance_offset){
+        Relocate();
         vkCmdDrawIndexed(vk_command_buffer,
                          index_allocation.count,  instance_count,
                          index_allocation.offset, vertex_allocation.offset, instance_offset);
     }
+    DrawPacket CreateDrawPacket(Pipeline* pipeline, DescriptorSet descriptor_set,
+                                uint32_t instance_count, uint32_t instance_offset){
+        Relocate();
+        DrawPacket packet{};
+        packet.pipeline       = pipeline;
+        packet.descriptor_set = descriptor_set;
+        packet.vertex_buffer  = gpu_buffer.GetBuffer(vertex_allocation.page);
+        packet.index_buffer   = gpu_buffer.GetBuffer(index_allocation.page);
+        packet.vertex_buffer_page = vertex_allocation.page;
+        packet.index_buffer_page  = index_allocation.page;
+        packet.index_count    = index_allocation.count;
+        packet.first_index    = index_allocation.offset;
+        packet.vertex_offset  = (int32_t)vertex_allocation.offset;
+        packet.instance_count  = instance_count;
+        packet.instance_offset = instance_offset;
+        return packet;
+    }
     /*template<typename IT>
     void Draw(VkCommandBuffer vk_command_buffer, BAllocation<IT> instance_allocation,
               const uint32_t instance_offset, const uint32_t instance_count){
@@ -108,5 +134,7 @@ public:
     
     render::TBAllocation<T>       vertex_allocation;
     render::TBAllocation<uint32_t> index_allocation;
+    RelocationHandle vertex_handle = RELOCATION_INVALID_HANDLE;
+    RelocationHandle index_handle  = RELOCATION_INVALID_HANDLE;
 };
 }
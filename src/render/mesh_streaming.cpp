@@ -0,0 +1,230 @@
+#include "render/mesh_streaming.h"
+#include "render/staging.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace render{
+MeshStreamer mesh_streamer{};
+void MeshStreamer::Initialize(MeshStreamerInfo info){
+    info_ = info;
+}
+void MeshStreamer::Terminate(){
+    render::staging_manager.AwaitUploadCompletion();
+    for(StreamingMesh* mesh : meshes_){
+        render::memory_budget.UnregisterEvictable(mesh->evictable);
+        if(mesh->state != STREAMING_MESH_EVICTED){
+            render::gpu_buffer.FreeTracked(mesh->vertex_handle);
+            render::gpu_buffer.FreeTracked(mesh->index_handle);
+        }
+        delete mesh;
+    }
+    for(RetiredMesh& retired : retired_meshes_){
+        render::gpu_buffer.FreeTracked(retired.vertex_handle);
+        render::gpu_buffer.FreeTracked(retired.index_handle);
+    }
+    meshes_.clear();
+    retired_meshes_.clear();
+    loading_meshes_.clear();
+    lru_.clear();
+}
+
+StreamingMesh* MeshStreamer::Create(const void* vertex_data, uint32_t vertex_stride, uint32_t vertex_count,
+                                    const uint32_t* index_data, uint32_t index_count, glm::vec3 center, float radius){
+    StreamingMesh* mesh = new StreamingMesh{};
+    mesh->vertex_data.assign((const uint8_t*)vertex_data, (const uint8_t*)vertex_data + (size_t)vertex_stride * vertex_count);
+    mesh->index_data.assign(index_data, index_data + index_count);
+    mesh->vertex_stride = vertex_stride;
+    mesh->center = center;
+    mesh->radius = radius;
+    meshes_.emplace_back(mesh);
+    statistics.mesh_count++;
+    return mesh;
+}
+void MeshStreamer::Destroy(StreamingMesh* mesh){
+    if(mesh->state == STREAMING_MESH_LOADING){
+        render::staging_manager.AwaitUploadCompletion();
+        loading_meshes_.erase(std::find(loading_meshes_.begin(), loading_meshes_.end(), mesh));
+        mesh->state = STREAMING_MESH_RESIDENT;
+        std::lock_guard<std::mutex> lock(lru_mutex_);
+        mesh->lru_iterator = lru_.insert(lru_.end(), mesh);
+    }
+    if(mesh->state == STREAMING_MESH_RESIDENT){
+        Evict(mesh);
+    }
+    meshes_.erase(std::find(meshes_.begin(), meshes_.end(), mesh));
+    statistics.mesh_count--;
+    delete mesh;
+}
+
+bool MeshStreamer::Request(StreamingMesh* mesh){
+    if(mesh->state != STREAMING_MESH_RESIDENT){
+        mesh->requested.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    render::memory_budget.Touch(mesh->evictable);
+    std::lock_guard<std::mutex> lock(lru_mutex_);
+    mesh->last_drawn_frame = frame_;
+    lru_.splice(lru_.end(), lru_, mesh->lru_iterator);
+    return true;
+}
+void MeshStreamer::RequestByDistance(glm::vec3 viewer_position){
+    PROFILE_FUNCTION();
+    for(StreamingMesh* mesh : meshes_){
+        if(glm::length(mesh->center - viewer_position) - mesh->radius <= info_.load_distance){
+            Request(mesh);
+        }
+    }
+}
+
+DrawPacket MeshStreamer::CreateDrawPacket(StreamingMesh* mesh, Pipeline* pipeline, DescriptorSet descriptor_set,
+                                          uint32_t instance_count, uint32_t instance_offset){
+    DrawPacket packet{};
+    packet.pipeline       = pipeline;
+    packet.descriptor_set = descriptor_set;
+    const Region vertex_region = render::gpu_buffer.Resolve(mesh->vertex_handle);
+    const Region index_region  = render::gpu_buffer.Resolve(mesh->index_handle);
+    packet.vertex_buffer  = render::gpu_buffer.GetBuffer(vertex_region.page);
+    packet.index_buffer   = render::gpu_buffer.GetBuffer(index_region.page);
+    packet.vertex_buffer_page = vertex_region.page;
+    packet.index_buffer_page  = index_region.page;
+    packet.index_count    = (uint32_t)mesh->index_data.size();
+    packet.first_index    = (uint32_t)(index_region.offset / sizeof(uint32_t));
+    packet.vertex_offset  = (int32_t)(vertex_region.offset / mesh->vertex_stride);
+    packet.instance_count  = instance_count;
+    packet.instance_offset = instance_offset;
+    return packet;
+}
+
+// Regions Of Meshes Drawn Within The Frames In Flight May Still Be Read And Are Never Freed
+bool MeshStreamer::EvictLeastRecentlyDrawn(){
+    StreamingMesh* mesh;
+    {
+        std::lock_guard<std::mutex> lock(lru_mutex_);
+        if(lru_.empty() || lru_.front()->last_drawn_frame + info_.frame_count > frame_){
+            return false;
+        }
+        mesh = lru_.front();
+    }
+    Evict(mesh);
+    return true;
+}
+// Regions A Frame In Flight May Still Read Are Retired Rather Than Freed, As When Destroying A Mesh Drawn This Frame
+void MeshStreamer::Evict(StreamingMesh* mesh){
+    static core::MetricCounter* eviction_counter = core::metrics.Counter("mesh_evictions");
+    render::memory_budget.UnregisterEvictable(mesh->evictable);
+    mesh->evictable = EVICTABLE_INVALID_HANDLE;
+    {
+        std::lock_guard<std::mutex> lock(lru_mutex_);
+        lru_.erase(mesh->lru_iterator);
+    }
+    if(mesh->last_drawn_frame + info_.frame_count > frame_){
+        retired_meshes_.push_back({ mesh->vertex_handle, mesh->index_handle, mesh->last_drawn_frame });
+    }
+    else{
+        render::gpu_buffer.FreeTracked(mesh->vertex_handle);
+        render::gpu_buffer.FreeTracked(mesh->index_handle);
+    }
+    mesh->vertex_handle = RELOCATION_INVALID_HANDLE;
+    mesh->index_handle  = RELOCATION_INVALID_HANDLE;
+    mesh->state = STREAMING_MESH_EVICTED;
+    statistics.resident_count--;
+    statistics.resident_bytes -= mesh->ResidentBytes();
+    statistics.evicted_count++;
+    eviction_counter->Add(1);
+}
+bool MeshStreamer::Allocate(StreamingMesh* mesh){
+    const VkDeviceSize bytes = mesh->ResidentBytes();
+    while(info_.resident_budget != 0 && statistics.resident_bytes + bytes > info_.resident_budget){
+        if(!EvictLeastRecentlyDrawn()){
+            return false;
+        }
+    }
+    for(;;){
+        Region vertex_region;
+        Region index_region;
+        if(render::gpu_buffer.TryAllocate(mesh->vertex_data.size(), mesh->vertex_stride, &vertex_region)){
+            if(render::gpu_buffer.TryAllocate(mesh->index_data.size() * sizeof(uint32_t), sizeof(uint32_t),
+                                              &index_region)){
+                mesh->vertex_handle = render::gpu_buffer.Track(vertex_region, mesh->vertex_stride);
+                mesh->index_handle  = render::gpu_buffer.Track(index_region,  sizeof(uint32_t));
+                return true;
+            }
+            render::gpu_buffer.Free(vertex_region);
+        }
+        if(!EvictLeastRecentlyDrawn()){
+            return false;
+        }
+    }
+}
+
+void MeshStreamer::Update(uint64_t frame){
+    PROFILE_FUNCTION();
+    frame_ = frame;
+    static core::MetricCounter* streamed_in_counter = core::metrics.Counter("mesh_streamed_in");
+    static core::MetricGauge*   resident_gauge      = core::metrics.Gauge("mesh_resident_bytes");
+
+    for(auto iterator = retired_meshes_.begin(); iterator != retired_meshes_.end();){
+        if(iterator->frame + info_.frame_count > frame){
+            ++iterator;
+            continue;
+        }
+        render::gpu_buffer.FreeTracked(iterator->vertex_handle);
+        render::gpu_buffer.FreeTracked(iterator->index_handle);
+        iterator = retired_meshes_.erase(iterator);
+    }
+    // Meshes Become Drawable Once Their Upload Has Completed
+    if(!loading_meshes_.empty() && !render::staging_manager.recording && render::staging_manager.IsUploadComplete()){
+        std::lock_guard<std::mutex> lock(lru_mutex_);
+        for(StreamingMesh* mesh : loading_meshes_){
+            mesh->state = STREAMING_MESH_RESIDENT;
+            mesh->last_drawn_frame = frame;
+            mesh->lru_iterator = lru_.insert(lru_.end(), mesh);
+            // Called From memory_budget.BeginFrame, Which Skips Meshes Touched Within The Frames In Flight
+            mesh->evictable = render::memory_budget.RegisterEvictable(MEMORY_CATEGORY_MESH, mesh->ResidentBytes(),
+                                                                      [this, mesh]{
+                mesh->evictable = EVICTABLE_INVALID_HANDLE;
+                Evict(mesh);
+            });
+        }
+        streamed_in_counter->Add(loading_meshes_.size());
+        statistics.streamed_in_count += (uint32_t)loading_meshes_.size();
+        loading_meshes_.clear();
+    }
+    // Recording While An Earlier Batch Is In Flight Would Block On It
+    if(loading_meshes_.empty() && render::staging_manager.IsUploadComplete()){
+        VkDeviceSize uploaded_bytes = 0;
+        for(StreamingMesh* mesh : meshes_){
+            if(mesh->state != STREAMING_MESH_EVICTED || !mesh->requested.load(std::memory_order_relaxed)){
+                continue;
+            }
+            const VkDeviceSize bytes = mesh->ResidentBytes();
+            // A Single Mesh Larger Than The Budget Still Goes Through When Nothing Else Was Uploaded
+            if(uploaded_bytes > 0 && uploaded_bytes + bytes > info_.upload_bytes_per_frame){
+                break;
+            }
+            if(bytes + 16 > render::staging_manager.Available() || !Allocate(mesh)){
+                continue;
+            }
+            const Region vertex_region = render::gpu_buffer.Resolve(mesh->vertex_handle);
+            const Region index_region  = render::gpu_buffer.Resolve(mesh->index_handle);
+            void* vertex_destination = render::staging_manager.UploadToBuffer(mesh->vertex_data.size(), vertex_region.offset,
+                                                                              render::gpu_buffer.GetBuffer(vertex_region.page));
+            std::memcpy(vertex_destination, mesh->vertex_data.data(), mesh->vertex_data.size());
+            void* index_destination = render::staging_manager.UploadToBuffer(mesh->index_data.size() * sizeof(uint32_t),
+                                                                             index_region.offset,
+                                                                             render::gpu_buffer.GetBuffer(index_region.page));
+            std::memcpy(index_destination, mesh->index_data.data(), mesh->index_data.size() * sizeof(uint32_t));
+            
+            mesh->state = STREAMING_MESH_LOADING;
+            mesh->requested.store(false, std::memory_order_relaxed);
+            loading_meshes_.emplace_back(mesh);
+            uploaded_bytes += bytes;
+            statistics.resident_count++;
+            statistics.resident_bytes += bytes;
+        }
+    }
+    resident_gauge->Set((double)statistics.resident_bytes);
+}
+}
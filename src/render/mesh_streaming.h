@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "render/mesh.h"
+#include "render/memory_budget.h"
+
+namespace render{
+struct MeshStreamerInfo{
+    uint32_t frame_count = 2;
+    VkDeviceSize upload_bytes_per_frame = 32 * 1024 * 1024;
+    // Bytes Of gpu_buffer Streamed Meshes May Occupy Before Evicting, Zero Uses Whatever Is Free
+    VkDeviceSize resident_budget = 0;
+    // Meshes Whose Bounds Come Within This Distance Of The Viewer Are Requested By RequestByDistance
+    float load_distance = 100.0f;
+};
+
+enum StreamingMeshState{
+    STREAMING_MESH_EVICTED,
+    STREAMING_MESH_LOADING,
+    STREAMING_MESH_RESIDENT,
+};
+// The CPU Keeps Vertex And Index Data So An Evicted Mesh Can Be Streamed Back In
+struct StreamingMesh{
+    std::vector<uint8_t>  vertex_data;
+    std::vector<uint32_t> index_data;
+    uint32_t  vertex_stride;
+    glm::vec3 center;
+    float     radius;
+
+    std::atomic<StreamingMeshState> state = STREAMING_MESH_EVICTED;
+    RelocationHandle vertex_handle = RELOCATION_INVALID_HANDLE;
+    RelocationHandle index_handle  = RELOCATION_INVALID_HANDLE;
+    uint64_t last_drawn_frame = 0;
+    std::atomic<bool> requested = false;
+    // Valid While Resident, Front Of The List Is Least Recently Drawn
+    std::list<StreamingMesh*>::iterator lru_iterator;
+    EvictableHandle evictable = EVICTABLE_INVALID_HANDLE;
+
+    VkDeviceSize ResidentBytes() const{
+        return vertex_data.size() + index_data.size() * sizeof(uint32_t);
+    }
+};
+struct MeshStreamingStatistics{
+    uint32_t mesh_count;
+    uint32_t resident_count;
+    VkDeviceSize resident_bytes;
+    uint32_t streamed_in_count;
+    uint32_t evicted_count;
+};
+
+// Meshes Are Only Placed In gpu_buffer Once Requested; Update Streams Requested Meshes In Through The
+// Staging Manager Within A Per Frame Budget, Making Room By Freeing The Least Recently Drawn Ones.
+// Resident Meshes Are Also Registered With The Memory Budget, Which May Evict Them When Over Its Limits
+class MeshStreamer{
+public:
+    void Initialize(MeshStreamerInfo info = {});
+    void Terminate();
+
+    StreamingMesh* Create(const void* vertex_data, uint32_t vertex_stride, uint32_t vertex_count,
+                          const uint32_t* index_data, uint32_t index_count, glm::vec3 center, float radius);
+    void Destroy(StreamingMesh* mesh);
+
+    // Safe From Any Thread; Returns Whether The Mesh May Be Drawn This Frame, Queues It Otherwise
+    bool Request(StreamingMesh* mesh);
+    void RequestByDistance(glm::vec3 viewer_position);
+
+    DrawPacket CreateDrawPacket(StreamingMesh* mesh, Pipeline* pipeline, DescriptorSet descriptor_set,
+                                uint32_t instance_count, uint32_t instance_offset);
+
+    // Called On The Main Thread After The Frame's Fence Wait, Uploads Go Out With The Caller's SubmitUpload
+    void Update(uint64_t frame);
+
+    MeshStreamingStatistics statistics{};
+
+private:
+    bool Allocate(StreamingMesh* mesh);
+    void Evict(StreamingMesh* mesh);
+    bool EvictLeastRecentlyDrawn();
+
+    // Regions Of Meshes Evicted While Still Drawn By A Frame In Flight, Freed Once It Completes
+    struct RetiredMesh{
+        RelocationHandle vertex_handle;
+        RelocationHandle index_handle;
+        uint64_t frame;
+    };
+    MeshStreamerInfo info_{};
+    uint64_t frame_ = 0;
+    std::vector<RetiredMesh> retired_meshes_{};
+    std::vector<StreamingMesh*> meshes_{};
+    std::vector<StreamingMesh*> loading_meshes_{};
+    std::mutex lru_mutex_{};
+    std::list<StreamingMesh*> lru_{};
+};
+extern MeshStreamer mesh_streamer;
+}
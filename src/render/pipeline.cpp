@@ -1,8 +1,13 @@
 #include "pipeline.h"
+#include "render/shader_compiler.h"
+#include "render/bindless.h"
+#include "profiler.h"
 
 namespace render{
-VkShaderModule Shader::CompileGlsl(size_t buffer_size, char* buffer){
-    return VK_NULL_HANDLE;
+VkShaderModule Shader::CompileGlsl(ShaderStage shader_stage, size_t buffer_size, char* buffer,
+                                   const ShaderCompileOptions& options){
+    std::vector<uint32_t> spirv = render::shader_compiler.CompileGlsl(shader_stage, buffer_size, buffer, options);
+    return CompileSpirv(spirv.size() * sizeof(uint32_t), (char*)spirv.data());
 }
 VkShaderModule Shader::CompileSpirv(size_t buffer_size, char* buffer){
     VkShaderModuleCreateInfo create_info{};
@@ -21,19 +26,23 @@ VkShaderModule Shader::CompileSpirv(size_t buffer_size, char* buffer){
 }
 
 // --- Member Functions --- //
-Shader::Shader(ShaderStage shader_stage, ShaderFormat shader_code_format, size_t buffer_size, char* buffer)
+Shader::Shader(ShaderStage shader_stage, ShaderFormat shader_code_format, size_t buffer_size, char* buffer,
+               ShaderCompileOptions options)
 : shader_stage_(shader_stage) {
     switch(shader_code_format){
         case SHADER_FORMAT_GLSL:
+            CompileGlslAsync(buffer_size, buffer, options);
             break;
         case SHADER_FORMAT_SPIRV:
-            vk_shader_module_ = CompileSpirv(buffer_size, buffer);
+            CreateModule(buffer_size, buffer);
+            code_hash_ = HashBytes(buffer, buffer_size);
+            ready_ = true;
             break;
     }
 }
 Shader::Shader(ShaderInfo info)
 : shader_stage_(info.shader_stage) {
-    std::ifstream file(info.filepath);
+    std::ifstream file(info.filepath, std::ios::binary);
     file.seekg(0, std::ios::end);
     size_t size = file.tellg();
     file.seekg(0);
@@ -43,67 +52,233 @@ Shader::Shader(ShaderInfo info)
     
     switch(info.shader_code_format){
         case SHADER_FORMAT_GLSL:
+            CompileGlslAsync(size, buffer, info.compile_options);
             break;
         case SHADER_FORMAT_SPIRV:
-            vk_shader_module_ = CompileSpirv(size, buffer);
+            CreateModule(size, buffer);
+            code_hash_ = HashBytes(buffer, size);
+            ready_ = true;
             break;
     }
+    delete[] buffer;
 }
 Shader::~Shader(){
+    render::shader_compiler.AwaitShader(this);
     vkDestroyShaderModule(render::context.vk_device, vk_shader_module_, nullptr);
 }
 
+// The Cache Key Is Known Up Front So Pipelines Can Be Keyed Before The Module Exists
+void Shader::CompileGlslAsync(size_t buffer_size, char* buffer, ShaderCompileOptions options){
+    code_hash_ = render::shader_compiler.CacheKey(shader_stage_, buffer_size, buffer, options);
+    
+    std::string source(buffer, buffer_size);
+    // Errors Are Kept On The Shader Instead Of Escaping The Task, Waiters Are Released Either Way
+    core::threadpool.Dispatch([this, source, options]{
+        PROFILE_ZONE("Compile GLSL");
+        std::vector<uint32_t> spirv{};
+        std::string error_log{};
+        try{
+            spirv = render::shader_compiler.CompileGlsl(shader_stage_, source.size(), source.data(), options);
+        }
+        catch(const std::runtime_error& error){
+            error_log = error.what();
+            printf("%s\n", error.what());
+        }
+        
+        render::shader_compiler.compilation_mutex.lock();
+        if(error_log.empty()){
+            CreateModule(spirv.size() * sizeof(uint32_t), (char*)spirv.data());
+        }
+        else{
+            error_log_ = std::move(error_log);
+            failed_    = true;
+        }
+        ready_ = true;
+        render::shader_compiler.compilation_mutex.unlock();
+        render::shader_compiler.compilation_condition_variable.notify_all();
+        return core::Threadpool::TASK_COMPLETE;
+    });
+}
+
 ShaderStage Shader::GetStage(){
     return shader_stage_;
 }
 VkShaderModule Shader::GetModule(){
     return vk_shader_module_;
 }
+uint64_t Shader::GetCodeHash(){
+    return code_hash_;
+}
+bool Shader::IsReady(){
+    return ready_;
+}
+bool Shader::HasFailed(){
+    return failed_;
+}
+const std::string& Shader::GetErrorLog(){
+    return error_log_;
+}
+const ShaderReflection& Shader::GetReflection(){
+    return reflection_;
+}
+void Shader::CreateModule(size_t buffer_size, char* buffer){
+    vk_shader_module_ = CompileSpirv(buffer_size, buffer);
+    ReflectSpirv(buffer_size, (uint32_t*)buffer, &reflection_);
+}
 
-// --- Pipeline --- //
-Pipeline::Pipeline(){}
-Pipeline::~Pipeline(){}
+// --- Pipeline Key --- //
+// Shaders Are Identified By Their 64 Bit Code Hash Rather Than Their Code, Two Different Shaders
+// Would Only Share A Pipeline If Their Hashes Collided
+static void AppendShaderWords(std::vector<uint64_t>& words, const PipelineInfo& info, uint32_t stage_mask){
+    for(Shader* shader : info.shaders){
+        if(!(shader->GetStage() & stage_mask)){
+            continue;
+        }
+        words.emplace_back(shader->GetStage());
+        words.emplace_back(shader->GetCodeHash());
+    }
+}
+static void AppendVertexInputWords(std::vector<uint64_t>& words, const PipelineInfo& info){
+    words.emplace_back(info.vertex_bindings.size());
+    for(const VertexBinding& binding : info.vertex_bindings){
+        words.emplace_back(((uint64_t)binding.binding << 32) | binding.stride);
+        words.emplace_back(binding.input_rate);
+    }
+    words.emplace_back(info.vertex_attributes.size());
+    for(const VertexAttribute& attribute : info.vertex_attributes){
+        words.emplace_back(((uint64_t)attribute.location << 32) | attribute.binding);
+        words.emplace_back(((uint64_t)attribute.format   << 32) | attribute.offset);
+    }
+}
+static void AppendLayoutWords(std::vector<uint64_t>& words, const PipelineInfo& info){
+    words.emplace_back(info.push_constant_ranges.size());
+    for(const PushConstantRange& range : info.push_constant_ranges){
+        words.emplace_back(range.stageFlags);
+        words.emplace_back(((uint64_t)range.offset << 32) | range.size);
+    }
+    words.emplace_back(info.push_descriptor_set);
+    words.emplace_back(info.descriptor_set_layouts.size());
+    for(const DescriptorSetLayout& set_layout : info.descriptor_set_layouts){
+        words.emplace_back((uint64_t)set_layout.vk_descriptor_set_layout);
+    }
+}
+static void AppendRasterizationWords(std::vector<uint64_t>& words, const PipelineInfo& info){
+    words.emplace_back(((uint64_t)info.front_face << 32) | (uint64_t)info.cull_mode);
+}
+static void AppendDepthWords(std::vector<uint64_t>& words, const PipelineInfo& info){
+    words.emplace_back(((uint64_t)info.depth_test_enabled << 1) | (uint64_t)info.depth_write_enabled);
+}
 
-void Pipeline::Initialize(PipelineInfo info){
-    std::vector<VkPipelineShaderStageCreateInfo> vk_shader_stage_info{};
+// The Fallback Is Left Out, It Only Chooses What Draws While The Pipeline Compiles And Not The
+// VkPipeline Itself; Requests Differing Only In Fallback Share The First Requester's
+PipelineKey CreatePipelineKey(const PipelineInfo& info){
+    PipelineKey key{};
+    key.words.emplace_back(info.shaders.size());
+    AppendShaderWords(key.words, info, UINT32_MAX);
+    AppendVertexInputWords(key.words, info);
+    AppendLayoutWords(key.words, info);
+    key.words.emplace_back((uint64_t)info.render_buffer->vk_render_pass);
+    AppendRasterizationWords(key.words, info);
+    AppendDepthWords(key.words, info);
+    key.Finalize();
+    return key;
+}
+PipelineKey CreatePipelineLayoutKey(const PipelineInfo& info){
+    PipelineKey key{};
+    AppendLayoutWords(key.words, info);
+    key.Finalize();
+    return key;
+}
+// Each Library Is Keyed Only By The State Its Stage Consumes, So Permutations Share Unchanged Stages
+PipelineKey CreatePipelineLibraryKey(PipelineLibraryStage stage, const PipelineInfo& info){
+    PipelineKey key{};
+    key.words.emplace_back(stage);
+    switch(stage){
+        case PIPELINE_LIBRARY_STAGE_VERTEX_INPUT:
+            AppendVertexInputWords(key.words, info);
+            break;
+        case PIPELINE_LIBRARY_STAGE_PRE_RASTERIZATION:
+            AppendShaderWords(key.words, info, SHADER_STAGE_VERTEX);
+            AppendLayoutWords(key.words, info);
+            AppendRasterizationWords(key.words, info);
+            key.words.emplace_back((uint64_t)info.render_buffer->vk_render_pass);
+            break;
+        case PIPELINE_LIBRARY_STAGE_FRAGMENT_SHADER:
+            AppendShaderWords(key.words, info, SHADER_STAGE_FRAGMENT);
+            AppendLayoutWords(key.words, info);
+            AppendDepthWords(key.words, info);
+            key.words.emplace_back((uint64_t)info.render_buffer->vk_render_pass);
+            break;
+        case PIPELINE_LIBRARY_STAGE_FRAGMENT_OUTPUT:
+            key.words.emplace_back((uint64_t)info.render_buffer->vk_render_pass);
+            break;
+        default:
+            break;
+    }
+    key.Finalize();
+    return key;
+}
+
+// --- Pipeline State --- //
+// Holds Every Fixed Function Create Info For One PipelineInfo, Must Not Be Moved Once Filled
+struct PipelineState{
+    void Fill(const PipelineInfo& info, uint32_t stage_mask);
+    VkGraphicsPipelineCreateInfo CreateInfo(VkPipelineLayout pipeline_layout);
+    
+    RenderBuffer* render_buffer;
+    std::vector<VkPipelineShaderStageCreateInfo> vk_shader_stage_info;
+    VkDynamicState dynamic_states[2];
+    VkPipelineDynamicStateCreateInfo       dynamic_state;
+    VkPipelineVertexInputStateCreateInfo   vertex_info;
+    VkPipelineInputAssemblyStateCreateInfo input_assembly;
+    VkPipelineViewportStateCreateInfo      viewport_state;
+    VkPipelineRasterizationStateCreateInfo rasterizer;
+    VkPipelineMultisampleStateCreateInfo   multisampling;
+    VkPipelineColorBlendAttachmentState    blend_attachment;
+    VkPipelineDepthStencilStateCreateInfo  depth_stencil;
+    VkPipelineColorBlendStateCreateInfo    blend_state;
+};
+void PipelineState::Fill(const PipelineInfo& info, uint32_t stage_mask){
+    render_buffer = info.render_buffer;
+    
     VkPipelineShaderStageCreateInfo stage_info{};
     stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     stage_info.pName = "main";
     for(Shader* shader : info.shaders){
+        if(!(shader->GetStage() & stage_mask)){
+            continue;
+        }
         stage_info.stage = (VkShaderStageFlagBits)shader->GetStage();
         stage_info.module = shader->GetModule();
         vk_shader_stage_info.emplace_back(stage_info);
     }
 
-    VkDynamicState dynamic_states[] = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
-    };
+    dynamic_states[0] = VK_DYNAMIC_STATE_VIEWPORT;
+    dynamic_states[1] = VK_DYNAMIC_STATE_SCISSOR;
     
-    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state = {};
     dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamic_state.dynamicStateCount = 2;
     dynamic_state.pDynamicStates = dynamic_states;
     
-    VkPipelineVertexInputStateCreateInfo vertex_info{};
+    vertex_info = {};
     vertex_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_info.vertexBindingDescriptionCount = (uint32_t)info.vertex_bindings.size();
     vertex_info.pVertexBindingDescriptions    = (VkVertexInputBindingDescription*)info.vertex_bindings.data();
     vertex_info.vertexAttributeDescriptionCount = (uint32_t)info.vertex_attributes.size();
     vertex_info.pVertexAttributeDescriptions    = (VkVertexInputAttributeDescription*)info.vertex_attributes.data();
     
-    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly = {};
     input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
     input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     input_assembly.primitiveRestartEnable = VK_FALSE;
     
-     
-     VkPipelineViewportStateCreateInfo viewport_state{};
-     viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-     viewport_state.viewportCount = 1;
-     viewport_state.scissorCount  = 1;
+    viewport_state = {};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount  = 1;
     
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
@@ -118,7 +293,7 @@ void Pipeline::Initialize(PipelineInfo info){
     rasterizer.depthBiasClamp = 0.0f;
     rasterizer.depthBiasSlopeFactor = 0.0f;
     
-    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling = {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -127,7 +302,7 @@ void Pipeline::Initialize(PipelineInfo info){
     multisampling.alphaToCoverageEnable = VK_FALSE;
     multisampling.alphaToOneEnable = VK_FALSE;
     
-    VkPipelineColorBlendAttachmentState blend_attachment{};
+    blend_attachment = {};
     blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     blend_attachment.blendEnable = VK_FALSE;
     blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
@@ -137,7 +312,7 @@ void Pipeline::Initialize(PipelineInfo info){
     blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
     blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
     
-    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil = {};
     depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depth_stencil.flags = 0;
     depth_stencil.depthTestEnable  = info.depth_test_enabled;
@@ -152,7 +327,7 @@ void Pipeline::Initialize(PipelineInfo info){
     depth_stencil.front = {};
     depth_stencil.back  = {};
     
-    VkPipelineColorBlendStateCreateInfo blend_state{};
+    blend_state = {};
     blend_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
     blend_state.logicOpEnable = VK_FALSE;
     blend_state.logicOp = VK_LOGIC_OP_COPY;
@@ -162,22 +337,8 @@ void Pipeline::Initialize(PipelineInfo info){
     blend_state.blendConstants[1] = 0.0f;
     blend_state.blendConstants[2] = 0.0f;
     blend_state.blendConstants[3] = 0.0f;
-    
-    /* Pipeline Layout */
-    VkPipelineLayoutCreateInfo layout_info{};
-    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    layout_info.pushConstantRangeCount = (uint32_t)info.push_constant_ranges.size();
-    layout_info.pPushConstantRanges    = (VkPushConstantRange*)info.push_constant_ranges.data();
-    layout_info.setLayoutCount = (uint32_t)info.descriptor_set_layouts.size();
-    layout_info.pSetLayouts    = (VkDescriptorSetLayout*)info.descriptor_set_layouts.data();
-    
-    VkPipelineLayout pipeline_layout;
-    VkResult vk_result = vkCreatePipelineLayout(render::context.vk_device,
-                                                &layout_info, nullptr, &pipeline_layout);
-    if (vk_result != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
-    
+}
+VkGraphicsPipelineCreateInfo PipelineState::CreateInfo(VkPipelineLayout pipeline_layout){
     VkGraphicsPipelineCreateInfo pipeline_info{};
     pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipeline_info.stageCount = (uint32_t)vk_shader_stage_info.size();
@@ -194,29 +355,99 @@ void Pipeline::Initialize(PipelineInfo info){
     
     pipeline_info.layout = pipeline_layout;
     
-    pipeline_info.renderPass = info.render_buffer->vk_render_pass;
+    pipeline_info.renderPass = render_buffer->vk_render_pass;
     pipeline_info.subpass = 0;
     
-    pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
     pipeline_info.basePipelineIndex = -1;
+    return pipeline_info;
+}
+
+// --- Pipeline --- //
+Pipeline::Pipeline(){}
+Pipeline::~Pipeline(){}
+
+void Pipeline::Initialize(PipelineInfo info){
+    // Layout And Vertex Input Left Empty By The Caller Are Derived From The Shaders
+    if(info.descriptor_set_layouts.empty()){
+        info.descriptor_set_layouts = render::pipeline_manager.ReflectDescriptorSetLayouts(info.shaders);
+    }
+    if(info.push_constant_ranges.empty()){
+        info.push_constant_ranges = render::pipeline_manager.ReflectPushConstantRanges(info.shaders);
+    }
+    if(info.vertex_bindings.empty() && info.vertex_attributes.empty()){
+        render::pipeline_manager.ReflectVertexInput(info.shaders, &info);
+    }
+    for(const PushConstantRange& range : info.push_constant_ranges){
+        push_constant_stage_flags |= range.stageFlags;
+    }
+    if(info.push_descriptor_set < info.descriptor_set_layouts.size() && render::context.push_descriptor_supported){
+        DescriptorSetLayout& set_layout = info.descriptor_set_layouts[info.push_descriptor_set];
+        set_layout = render::descriptor_set_layout_cache.Get(set_layout.bindings,
+                                                             VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
+        push_descriptor_set_index = info.push_descriptor_set;
+    }
+    for(uint32_t i = 0; i < info.descriptor_set_layouts.size(); i++){
+        if(render::bindless_table.IsEnabled() &&
+           info.descriptor_set_layouts[i].vk_descriptor_set_layout == render::bindless_table.set_layout.vk_descriptor_set_layout){
+            bindless_set_index = i;
+        }
+    }
     
-    VkPipeline pipeline;
-    vk_result = vkCreateGraphicsPipelines(render::context.vk_device, VK_NULL_HANDLE,
-                                          1, &pipeline_info, nullptr, &pipeline);
+    VkPipelineLayout pipeline_layout = render::pipeline_manager.GetPipelineLayout(info);
     
+    VkResult vk_result = VK_SUCCESS;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    auto compile_start = std::chrono::high_resolution_clock::now();
+    if(render::pipeline_manager.use_pipeline_library && render::context.graphics_pipeline_library_supported){
+        VkPipeline libraries[PIPELINE_LIBRARY_STAGE_COUNT];
+        for(uint32_t stage = 0; stage < PIPELINE_LIBRARY_STAGE_COUNT; stage++){
+            libraries[stage] = render::pipeline_manager.GetLibrary((PipelineLibraryStage)stage, info, pipeline_layout);
+        }
+        // Only The Link Is Timed, Libraries Are Shared Across Pipelines And Built Once
+        compile_start = std::chrono::high_resolution_clock::now();
+        
+        VkPipelineLibraryCreateInfoKHR library_info{};
+        library_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+        library_info.pNext = nullptr;
+        library_info.libraryCount = PIPELINE_LIBRARY_STAGE_COUNT;
+        library_info.pLibraries   = libraries;
+        
+        VkGraphicsPipelineCreateInfo pipeline_info{};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipeline_info.pNext = &library_info;
+        pipeline_info.layout = pipeline_layout;
+        pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+        pipeline_info.basePipelineIndex = -1;
+        
+        vk_result = vkCreateGraphicsPipelines(render::context.vk_device, render::pipeline_manager.vk_pipeline_cache,
+                                              1, &pipeline_info, nullptr, &pipeline);
+        linked = true;
+    } else {
+        PipelineState state{};
+        state.Fill(info, UINT32_MAX);
+        VkGraphicsPipelineCreateInfo pipeline_info = state.CreateInfo(pipeline_layout);
+        
+        vk_result = vkCreateGraphicsPipelines(render::context.vk_device, render::pipeline_manager.vk_pipeline_cache,
+                                              1, &pipeline_info, nullptr, &pipeline);
+    }
+    auto compile_finish = std::chrono::high_resolution_clock::now();
+    compile_milliseconds =
+    std::chrono::duration_cast<std::chrono::microseconds>(compile_finish - compile_start).count() / 1000.0f;
+    
+    if (vk_result != VK_SUCCESS) {
+        printf("FAILED TO CREATE GRAPHICS PIPELINE -> VkResult %d\n", vk_result);
+    }
     render::pipeline_manager.compilation_mutex.lock();
     vk_pipeline_layout = pipeline_layout;
     vk_pipeline        = pipeline;
+    failed.store(vk_result != VK_SUCCESS, std::memory_order_release);
+    compiled.store(vk_result == VK_SUCCESS, std::memory_order_release);
     render::pipeline_manager.compilation_mutex.unlock();
-
-    if (vk_result != VK_SUCCESS) {
-        throw std::runtime_error("FAILED TO CREATE GRAPHICS PIPELINE");
-    }
 }
+// Pipeline Layouts Are Shared Through PipelineManager And Destroyed With It
 void Pipeline::Terminate(){
     vkDestroyPipeline(render::context.vk_device, vk_pipeline, nullptr);
-    vkDestroyPipelineLayout(render::context.vk_device, vk_pipeline_layout, nullptr);
 }
 
 void Pipeline::Bind(VkCommandBuffer command_buffer){
@@ -224,26 +455,318 @@ void Pipeline::Bind(VkCommandBuffer command_buffer){
 }
 void Pipeline::PushConstant(VkCommandBuffer vk_command_buffer,
                             VkDeviceSize size, VkDeviceSize offset, void* data){
-    vkCmdPushConstants(vk_command_buffer, vk_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, 64, data);
+    vkCmdPushConstants(vk_command_buffer, vk_pipeline_layout, push_constant_stage_flags,
+                       (uint32_t)offset, (uint32_t)size, data);
 }
 void Pipeline::BindDescriptorSet(VkCommandBuffer vk_command_buffer, 
                                  DescriptorSet descriptor_set, uint32_t binding){
     vkCmdBindDescriptorSets(vk_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline_layout, 
                             binding, 1, &descriptor_set.vk_descriptor_set, 0, nullptr);
 }
+void Pipeline::PushDescriptorSet(VkCommandBuffer vk_command_buffer, DescriptorWriter* writer, uint32_t binding){
+    if(binding != push_descriptor_set_index){
+        throw std::runtime_error("DESCRIPTOR SET WAS NOT CREATED FOR PUSH DESCRIPTORS");
+    }
+    writer->Push(vk_command_buffer, vk_pipeline_layout, binding);
+}
 
 
 
 
 PipelineManager pipeline_manager{};
-void PipelineManager::Initialize(){}
-void PipelineManager::Terminate(){}
+void PipelineManager::Initialize(const char* pipeline_cache_filepath){
+    this->pipeline_cache_filepath = pipeline_cache_filepath;
+    LoadPipelineCache();
+}
+void PipelineManager::Terminate(){
+    for(auto& [key, library] : library_map){
+        vkDestroyPipeline(render::context.vk_device, library->vk_pipeline, nullptr);
+    }
+    library_map.clear();
+    for(auto& [key, pipeline_layout] : layout_map){
+        vkDestroyPipelineLayout(render::context.vk_device, pipeline_layout, nullptr);
+    }
+    layout_map.clear();
+    
+    SavePipelineCache();
+    vkDestroyPipelineCache(render::context.vk_device, vk_pipeline_cache, nullptr);
+    vk_pipeline_cache = VK_NULL_HANDLE;
+}
+
+// Cache Data From Another Device Or Driver Is Discarded Rather Than Handed To The Driver
+void PipelineManager::LoadPipelineCache(){
+    std::vector<char> cache_data{};
+    std::ifstream file(pipeline_cache_filepath, std::ios::binary);
+    if(file.is_open()){
+        file.seekg(0, std::ios::end);
+        size_t size = file.tellg();
+        file.seekg(0);
+        cache_data.resize(size);
+        file.read(cache_data.data(), size);
+    }
+    
+    if(cache_data.size() >= sizeof(VkPipelineCacheHeaderVersionOne)){
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(render::context.vk_physical_device, &properties);
+        
+        VkPipelineCacheHeaderVersionOne header{};
+        std::memcpy(&header, cache_data.data(), sizeof(header));
+        if(header.headerSize    <  sizeof(VkPipelineCacheHeaderVersionOne) ||
+           header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+           header.vendorID      != properties.vendorID ||
+           header.deviceID      != properties.deviceID ||
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0){
+            printf("PIPELINE CACHE: %s | INCOMPATIBLE, DISCARDING\n", pipeline_cache_filepath);
+            cache_data.clear();
+        }
+    } else {
+        cache_data.clear();
+    }
+    
+    VkPipelineCacheCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    create_info.pNext = nullptr;
+    create_info.flags = 0;
+    create_info.initialDataSize = cache_data.size();
+    create_info.pInitialData    = cache_data.data();
+    
+    VkResult vk_result = vkCreatePipelineCache(render::context.vk_device, &create_info, nullptr, &vk_pipeline_cache);
+    if(vk_result != VK_SUCCESS && cache_data.size() != 0){
+        create_info.initialDataSize = 0;
+        create_info.pInitialData    = nullptr;
+        cache_data.clear();
+        vk_result = vkCreatePipelineCache(render::context.vk_device, &create_info, nullptr, &vk_pipeline_cache);
+    }
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE PIPELINE CACHE");
+    }
+    pipeline_cache_warm = cache_data.size() != 0;
+}
+void PipelineManager::SavePipelineCache(){
+    if(vk_pipeline_cache == VK_NULL_HANDLE){
+        return;
+    }
+    size_t size = 0;
+    vkGetPipelineCacheData(render::context.vk_device, vk_pipeline_cache, &size, nullptr);
+    std::vector<char> cache_data(size);
+    VkResult vk_result = vkGetPipelineCacheData(render::context.vk_device, vk_pipeline_cache, &size, cache_data.data());
+    if(vk_result != VK_SUCCESS || size == 0){
+        return;
+    }
+    
+    std::ofstream file(pipeline_cache_filepath, std::ios::binary | std::ios::trunc);
+    file.write(cache_data.data(), size);
+}
 
+// GLSL Shaders Are Reflected On The Threadpool As They Compile, Each Stage Is Awaited Before Its Reflection Is Read
+std::vector<DescriptorSetLayout> PipelineManager::ReflectDescriptorSetLayouts(const std::vector<Shader*>& shaders){
+    std::vector<const ShaderReflection*> reflections{};
+    for(Shader* shader : shaders){
+        render::shader_compiler.AwaitShader(shader);
+        reflections.emplace_back(&shader->GetReflection());
+    }
+    ShaderReflection merged = MergeShaderReflections(reflections);
+    
+    std::vector<DescriptorSetLayout> set_layouts{};
+    for(const std::vector<DescriptorBinding>& bindings : merged.descriptor_sets){
+        if(render::bindless_table.Matches(bindings)){
+            set_layouts.emplace_back(render::bindless_table.set_layout);
+            continue;
+        }
+        set_layouts.emplace_back(render::descriptor_set_layout_cache.Get(bindings));
+    }
+    return set_layouts;
+}
+std::vector<PushConstantRange> PipelineManager::ReflectPushConstantRanges(const std::vector<Shader*>& shaders){
+    std::vector<const ShaderReflection*> reflections{};
+    for(Shader* shader : shaders){
+        render::shader_compiler.AwaitShader(shader);
+        reflections.emplace_back(&shader->GetReflection());
+    }
+    ShaderReflection merged = MergeShaderReflections(reflections);
+    
+    std::vector<PushConstantRange> ranges{};
+    for(const VkPushConstantRange& range : merged.push_constant_ranges){
+        ranges.push_back({ (ShaderStage)range.stageFlags, range.offset, range.size });
+    }
+    return ranges;
+}
+// Without A Caller Supplied Layout, Vertex Inputs Are Packed Tightly Into Binding 0 In Location Order
+void PipelineManager::ReflectVertexInput(const std::vector<Shader*>& shaders, PipelineInfo* info){
+    uint32_t offset = 0;
+    for(Shader* shader : shaders){
+        render::shader_compiler.AwaitShader(shader);
+        for(const ReflectedVertexInput& input : shader->GetReflection().vertex_inputs){
+            info->vertex_attributes.push_back({ input.location, 0, input.format, offset });
+            offset += FormatSize(input.format);
+        }
+    }
+    if(offset != 0){
+        info->vertex_bindings.push_back({ 0, offset, VK_VERTEX_INPUT_RATE_VERTEX });
+    }
+}
+
+VkPipelineLayout PipelineManager::GetPipelineLayout(const PipelineInfo& info){
+    PipelineKey key = CreatePipelineLayoutKey(info);
+    
+    std::lock_guard<std::mutex> lock(layout_map_mutex);
+    auto iterator = layout_map.find(key);
+    if(iterator != layout_map.end()){
+        return iterator->second;
+    }
+    
+    VkPipelineLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layout_info.pushConstantRangeCount = (uint32_t)info.push_constant_ranges.size();
+    layout_info.pPushConstantRanges    = (VkPushConstantRange*)info.push_constant_ranges.data();
+    layout_info.setLayoutCount = (uint32_t)info.descriptor_set_layouts.size();
+    layout_info.pSetLayouts    = (VkDescriptorSetLayout*)info.descriptor_set_layouts.data();
+    
+    VkPipelineLayout pipeline_layout;
+    VkResult vk_result = vkCreatePipelineLayout(render::context.vk_device,
+                                                &layout_info, nullptr, &pipeline_layout);
+    if (vk_result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+    layout_map.emplace(std::move(key), pipeline_layout);
+    return pipeline_layout;
+}
+
+// Concurrent Requests For The Same Library Wait On The First Compile Instead Of Duplicating It
+VkPipeline PipelineManager::GetLibrary(PipelineLibraryStage stage, const PipelineInfo& info,
+                                       VkPipelineLayout pipeline_layout){
+    PipelineKey key = CreatePipelineLibraryKey(stage, info);
+    
+    library_map_mutex.lock();
+    std::shared_ptr<PipelineLibrary>& entry = library_map[key];
+    if(entry == nullptr){
+        entry = std::make_shared<PipelineLibrary>();
+    }
+    std::shared_ptr<PipelineLibrary> library = entry;
+    library_map_mutex.unlock();
+    
+    std::call_once(library->once_flag, [this, stage, &info, pipeline_layout, library]{
+        VkGraphicsPipelineLibraryCreateInfoEXT library_create_info{};
+        library_create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+        library_create_info.pNext = nullptr;
+        
+        PipelineState state{};
+        VkGraphicsPipelineCreateInfo pipeline_info{};
+        switch(stage){
+            case PIPELINE_LIBRARY_STAGE_VERTEX_INPUT:
+                library_create_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+                state.Fill(info, 0);
+                pipeline_info = state.CreateInfo(VK_NULL_HANDLE);
+                pipeline_info.pViewportState      = nullptr;
+                pipeline_info.pRasterizationState = nullptr;
+                pipeline_info.pMultisampleState   = nullptr;
+                pipeline_info.pDepthStencilState  = nullptr;
+                pipeline_info.pColorBlendState    = nullptr;
+                pipeline_info.pDynamicState       = nullptr;
+                pipeline_info.renderPass = VK_NULL_HANDLE;
+                break;
+            case PIPELINE_LIBRARY_STAGE_PRE_RASTERIZATION:
+                library_create_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+                state.Fill(info, SHADER_STAGE_VERTEX);
+                pipeline_info = state.CreateInfo(pipeline_layout);
+                pipeline_info.pVertexInputState   = nullptr;
+                pipeline_info.pInputAssemblyState = nullptr;
+                pipeline_info.pMultisampleState   = nullptr;
+                pipeline_info.pDepthStencilState  = nullptr;
+                pipeline_info.pColorBlendState    = nullptr;
+                break;
+            case PIPELINE_LIBRARY_STAGE_FRAGMENT_SHADER:
+                library_create_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+                state.Fill(info, SHADER_STAGE_FRAGMENT);
+                pipeline_info = state.CreateInfo(pipeline_layout);
+                pipeline_info.pVertexInputState   = nullptr;
+                pipeline_info.pInputAssemblyState = nullptr;
+                pipeline_info.pViewportState      = nullptr;
+                pipeline_info.pRasterizationState = nullptr;
+                pipeline_info.pColorBlendState    = nullptr;
+                pipeline_info.pDynamicState       = nullptr;
+                break;
+            case PIPELINE_LIBRARY_STAGE_FRAGMENT_OUTPUT:
+            default:
+                library_create_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+                state.Fill(info, 0);
+                pipeline_info = state.CreateInfo(VK_NULL_HANDLE);
+                pipeline_info.pVertexInputState   = nullptr;
+                pipeline_info.pInputAssemblyState = nullptr;
+                pipeline_info.pViewportState      = nullptr;
+                pipeline_info.pRasterizationState = nullptr;
+                pipeline_info.pDepthStencilState  = nullptr;
+                pipeline_info.pDynamicState       = nullptr;
+                break;
+        }
+        pipeline_info.pNext = &library_create_info;
+        pipeline_info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+        
+        VkResult vk_result = vkCreateGraphicsPipelines(render::context.vk_device, vk_pipeline_cache,
+                                                       1, &pipeline_info, nullptr, &library->vk_pipeline);
+        if(vk_result != VK_SUCCESS){
+            throw std::runtime_error("FAILED TO CREATE GRAPHICS PIPELINE LIBRARY");
+        }
+    });
+    return library->vk_pipeline;
+}
+
+// Identical Requests Share One Pipeline, Returned Immediately Whether Compiled Or Still In Flight
 Pipeline* PipelineManager::Compile(PipelineInfo info){
+    PROFILE_FUNCTION();
+    PipelineKey key = CreatePipelineKey(info);
+    
+    std::lock_guard<std::mutex> lock(pipeline_map_mutex);
+    auto iterator = pipeline_map.find(key);
+    if(iterator != pipeline_map.end()){
+        iterator->second->reference_count++;
+        return iterator->second;
+    }
+    
+    uint32_t sort_id;
+    if(!free_sort_ids.empty()){
+        sort_id = free_sort_ids.back();
+        free_sort_ids.pop_back();
+    }
+    else if(next_sort_id <= max_sort_id){
+        sort_id = next_sort_id++;
+    }
+    else{
+        throw std::runtime_error("PIPELINE SORT ID EXCEEDS DRAW KEY BITS");
+    }
     Pipeline* new_pipeline = new Pipeline{};
+    new_pipeline->sort_id = (uint16_t)sort_id;
+    new_pipeline->reference_count = 1;
+    new_pipeline->key = key;
+    new_pipeline->fallback = info.fallback;
+    pipeline_map.emplace(std::move(key), new_pipeline);
     
     core::threadpool.Dispatch([this, new_pipeline, info]{
-        new_pipeline->Initialize(info);
+        for(Shader* shader : info.shaders){
+            if(!shader->IsReady()){
+                return core::Threadpool::TASK_NOT_READY;
+            }
+        }
+        for(Shader* shader : info.shaders){
+            if(shader->HasFailed()){
+                printf("PIPELINE NOT COMPILED, SHADER FAILED -> %s\n", shader->GetErrorLog().c_str());
+                compilation_mutex.lock();
+                new_pipeline->failed.store(true, std::memory_order_release);
+                compilation_mutex.unlock();
+                compilation_condition_variable.notify_all();
+                return core::Threadpool::TASK_COMPLETE;
+            }
+        }
+        PROFILE_ZONE("Compile Pipeline");
+        try{
+            new_pipeline->Initialize(info);
+        }
+        catch(const std::runtime_error& error){
+            printf("PIPELINE NOT COMPILED -> %s\n", error.what());
+            compilation_mutex.lock();
+            new_pipeline->failed.store(true, std::memory_order_release);
+            compilation_mutex.unlock();
+        }
         compilation_condition_variable.notify_all();
         return core::Threadpool::TASK_COMPLETE;
     });
@@ -251,13 +774,48 @@ Pipeline* PipelineManager::Compile(PipelineInfo info){
     return new_pipeline;
 }
 void PipelineManager::AwaitCompilation(Pipeline* pipeline){
+    PROFILE_FUNCTION();
     std::unique_lock<std::mutex> lock(compilation_mutex);
     compilation_condition_variable.wait(lock, [pipeline]{
-        return pipeline->vk_pipeline != VK_NULL_HANDLE;
+        return pipeline->vk_pipeline != VK_NULL_HANDLE || pipeline->failed.load(std::memory_order_acquire);
     });
 }
 
+bool PipelineManager::IsReady(Pipeline* pipeline){
+    return pipeline != nullptr && pipeline->compiled.load(std::memory_order_acquire);
+}
+// Returns The Pipeline To Draw With This Frame, Or nullptr If The Draw Should Be Skipped;
+// A Failed Pipeline Is Never Ready, So It Keeps Resolving To Its Fallback
+Pipeline* PipelineManager::Resolve(Pipeline* pipeline){
+    if(IsReady(pipeline)){
+        return pipeline;
+    }
+    if(not_ready_mode == PIPELINE_NOT_READY_SKIP){
+        return nullptr;
+    }
+    if(IsReady(pipeline->fallback)){
+        return pipeline->fallback;
+    }
+    if(IsReady(default_fallback)){
+        return default_fallback;
+    }
+    return nullptr;
+}
+void PipelineManager::RegisterFallback(Pipeline* pipeline){
+    default_fallback = pipeline;
+}
+
 void PipelineManager::Destroy(Pipeline* pipeline){
+    pipeline_map_mutex.lock();
+    if(--pipeline->reference_count != 0){
+        pipeline_map_mutex.unlock();
+        return;
+    }
+    pipeline_map.erase(pipeline->key);
+    free_sort_ids.push_back(pipeline->sort_id);
+    pipeline_map_mutex.unlock();
+    
+    AwaitCompilation(pipeline);
     pipeline->Terminate();
     delete pipeline;
 }
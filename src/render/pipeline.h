@@ -1,18 +1,26 @@
 #pragma once
 #include <fstream>
+#include <cstring>
 
 #include <deque>
+#include <unordered_map>
+#include <memory>
+#include <string>
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <chrono>
 
 #include "glm.hpp"
 
 #include "thread_pool.h"
 
 #include "render/context.h"
+#include "render/hash.h"
 #include "render/render_buffer.h"
 #include "render/descriptor.h"
+#include "render/shader_reflection.h"
 
 
 namespace render{
@@ -24,29 +32,51 @@ enum ShaderFormat{
     SHADER_FORMAT_GLSL,
     SHADER_FORMAT_SPIRV,
 };
+struct ShaderCompileOptions{
+    std::vector<std::string> defines;
+    bool optimize = false;
+    bool strip_debug_info = false;
+};
 struct ShaderInfo{
     ShaderStage  shader_stage;
     ShaderFormat shader_code_format;
     const char* filepath;
     size_t buffer_size;
     char* buffer;
+    ShaderCompileOptions compile_options;
 };
 class Shader{
 public:
-    static VkShaderModule CompileGlsl(size_t buffer_size, char* buffer);
+    static VkShaderModule CompileGlsl(ShaderStage shader_stage, size_t buffer_size, char* buffer,
+                                      const ShaderCompileOptions& options);
     static VkShaderModule CompileSpirv(size_t buffer_size, char* buffer);
     
 public:
-    Shader(ShaderStage shader_stage, ShaderFormat shader_code_format, size_t buffer_size, char* buffer);
+    Shader(ShaderStage shader_stage, ShaderFormat shader_code_format, size_t buffer_size, char* buffer,
+           ShaderCompileOptions options = {});
     Shader(ShaderInfo info);
     ~Shader();
     
     ShaderStage GetStage();
     VkShaderModule GetModule();
+    uint64_t GetCodeHash();
+    // Ready Once Compilation Finished, Whether Or Not It Succeeded
+    bool IsReady();
+    bool HasFailed();
+    const std::string& GetErrorLog();
+    const ShaderReflection& GetReflection();
     
 private:
+    void CompileGlslAsync(size_t buffer_size, char* buffer, ShaderCompileOptions options);
+    void CreateModule(size_t buffer_size, char* buffer);
+    
     ShaderStage shader_stage_;
-    VkShaderModule   vk_shader_module_;
+    ShaderReflection reflection_;
+    uint64_t code_hash_ = 0;
+    std::atomic<bool> ready_ = false;
+    std::atomic<bool> failed_ = false;
+    std::string error_log_;
+    VkShaderModule   vk_shader_module_ = VK_NULL_HANDLE;
 };
 
 struct VertexBinding{
@@ -94,9 +124,12 @@ struct PushConstantRange{
     uint32_t         offset;
     uint32_t         size;
 };
+class Pipeline;
 struct PipelineInfo{
     std::vector<PushConstantRange>   push_constant_ranges;
     std::vector<DescriptorSetLayout> descriptor_set_layouts;
+    // Set Whose Descriptors Are Pushed Per Draw Instead Of Allocated, When VK_KHR_push_descriptor Is Available
+    uint32_t push_descriptor_set = UINT32_MAX;
     
     std::vector<VertexBinding>   vertex_bindings;
     std::vector<VertexAttribute> vertex_attributes;
@@ -109,7 +142,22 @@ struct PipelineInfo{
     
     bool depth_test_enabled = false;
     bool depth_write_enabled = false;
+    
+    Pipeline* fallback = nullptr;
 };
+typedef StateKey     PipelineKey;
+typedef StateKeyHash PipelineKeyHash;
+enum PipelineLibraryStage{
+    PIPELINE_LIBRARY_STAGE_VERTEX_INPUT      = 0,
+    PIPELINE_LIBRARY_STAGE_PRE_RASTERIZATION = 1,
+    PIPELINE_LIBRARY_STAGE_FRAGMENT_SHADER   = 2,
+    PIPELINE_LIBRARY_STAGE_FRAGMENT_OUTPUT   = 3,
+    PIPELINE_LIBRARY_STAGE_COUNT             = 4,
+};
+PipelineKey CreatePipelineKey(const PipelineInfo& info);
+PipelineKey CreatePipelineLayoutKey(const PipelineInfo& info);
+PipelineKey CreatePipelineLibraryKey(PipelineLibraryStage stage, const PipelineInfo& info);
+
 class Pipeline {
 public:
     Pipeline();
@@ -121,23 +169,81 @@ public:
     void Bind(VkCommandBuffer command_buffer);
     void PushConstant(VkCommandBuffer vk_command_buffer, VkDeviceSize size, VkDeviceSize offset, void* data);
     void BindDescriptorSet(VkCommandBuffer vk_command_buffer, DescriptorSet descriptor_set, uint32_t binding);
+    void PushDescriptorSet(VkCommandBuffer vk_command_buffer, DescriptorWriter* writer, uint32_t binding);
     
-    VkPipelineLayout vk_pipeline_layout;
-    VkPipeline vk_pipeline;
+    uint16_t sort_id = 0;
+    float compile_milliseconds = 0.0f;
+    bool linked = false;
+    uint32_t reference_count = 0;
+    PipelineKey key;
+    Pipeline* fallback = nullptr;
+    std::atomic<bool> compiled = false;
+    // Set When A Shader Or The Pipeline Itself Failed To Compile, Draws Use The Fallback From Then On
+    std::atomic<bool> failed = false;
+    VkShaderStageFlags push_constant_stage_flags = 0;
+    uint32_t bindless_set_index = UINT32_MAX;
+    uint32_t push_descriptor_set_index = UINT32_MAX;
+    VkPipelineLayout vk_pipeline_layout = VK_NULL_HANDLE;
+    VkPipeline vk_pipeline = VK_NULL_HANDLE;
 };
 
+struct PipelineLibrary{
+    std::once_flag once_flag;
+    VkPipeline vk_pipeline = VK_NULL_HANDLE;
+};
+enum PipelineNotReadyMode{
+    PIPELINE_NOT_READY_SKIP,
+    PIPELINE_NOT_READY_FALLBACK,
+};
 class PipelineManager{
 public:
-    void Initialize();
+    void Initialize(const char* pipeline_cache_filepath = "pipeline_cache.bin");
     void Terminate();
     
+    void LoadPipelineCache();
+    void SavePipelineCache();
+    
+    std::vector<DescriptorSetLayout> ReflectDescriptorSetLayouts(const std::vector<Shader*>& shaders);
+    std::vector<PushConstantRange>   ReflectPushConstantRanges  (const std::vector<Shader*>& shaders);
+    void ReflectVertexInput(const std::vector<Shader*>& shaders, PipelineInfo* info);
+    
+    VkPipelineLayout GetPipelineLayout(const PipelineInfo& info);
+    VkPipeline GetLibrary(PipelineLibraryStage stage, const PipelineInfo& info, VkPipelineLayout pipeline_layout);
+    
     Pipeline* Compile(PipelineInfo info);
     void AwaitCompilation(Pipeline* pipeline);
     
+    bool IsReady(Pipeline* pipeline);
+    Pipeline* Resolve(Pipeline* pipeline);
+    void RegisterFallback(Pipeline* pipeline);
+    
     void Destroy(Pipeline* pipeline);
     
     std::mutex compilation_mutex;
     std::condition_variable compilation_condition_variable;
+    
+    PipelineNotReadyMode not_ready_mode = PIPELINE_NOT_READY_FALLBACK;
+    Pipeline* default_fallback = nullptr;
+    
+    // Sort Ids Fill The 12 Pipeline Bits Of A Draw Key, Ids Of Destroyed Pipelines Are Reused First;
+    // Both Are Guarded By pipeline_map_mutex
+    static constexpr uint32_t max_sort_id = 0xFFF;
+    uint32_t next_sort_id = 0;
+    std::vector<uint16_t> free_sort_ids;
+    
+    std::mutex pipeline_map_mutex;
+    std::unordered_map<PipelineKey, Pipeline*, PipelineKeyHash> pipeline_map;
+    
+    std::mutex layout_map_mutex;
+    std::unordered_map<PipelineKey, VkPipelineLayout, PipelineKeyHash> layout_map;
+    
+    bool use_pipeline_library = true;
+    std::mutex library_map_mutex;
+    std::unordered_map<PipelineKey, std::shared_ptr<PipelineLibrary>, PipelineKeyHash> library_map;
+    
+    const char* pipeline_cache_filepath;
+    bool pipeline_cache_warm = false;
+    VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
 };
 extern PipelineManager pipeline_manager;
 }
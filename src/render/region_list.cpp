@@ -0,0 +1,78 @@
+#include "render/region_list.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace render{
+RegionList::RegionList(){};
+RegionList::RegionList(size_t offset, size_t size) : list_({{offset, size}}) {}
+// First Fit; Alignment Padding Stays In The Free List Instead Of Being Handed Out
+bool RegionList::GetRegion(size_t size, size_t alignment, Region* acquired_region){
+    for(size_t i = 0; i < list_.size(); i++){
+        Region memory = list_[i];
+        size_t padding = 0;
+        if(alignment != 0 && memory.offset % alignment){
+            padding = alignment - (memory.offset % alignment);
+        }
+        if(memory.size < size + padding){
+            continue;
+        }
+        *acquired_region = Region{ memory.offset + padding, size };
+        const Region remainder = Region{ memory.offset + padding + size, memory.size - padding - size };
+        if(padding != 0){
+            list_[i].size = padding;
+            if(remainder.size != 0){
+                list_.insert(list_.begin() + i + 1, remainder);
+            }
+        }
+        else if(remainder.size != 0){
+            list_[i] = remainder;
+        }
+        else{
+            list_.erase(list_.begin() + i);
+        }
+        return true;
+    }
+    return false;
+}
+size_t RegionList::FreeBytes(){
+    size_t free_bytes = 0;
+    for(const Region& memory : list_){
+        free_bytes += memory.size;
+    }
+    return free_bytes;
+}
+size_t RegionList::LargestFreeRegion(){
+    size_t largest = 0;
+    for(const Region& memory : list_){
+        largest = std::max(largest, memory.size);
+    }
+    return largest;
+}
+float RegionList::Fragmentation(){
+    size_t free_bytes = FreeBytes();
+    return free_bytes == 0 ? 0.0f : 1.0f - (float)LargestFreeRegion() / (float)free_bytes;
+}
+// The List Stays Sorted By Offset, A Freed Region Merges With Both Neighbours When They Touch It
+void RegionList::FreeRegion(Region free_memory){
+    auto next = std::lower_bound(list_.begin(), list_.end(), free_memory.offset,
+                                 [](const Region& region, size_t offset){ return region.offset < offset; });
+    const bool merge_previous = next != list_.begin() &&
+                                std::prev(next)->offset + std::prev(next)->size == free_memory.offset;
+    const bool merge_next     = next != list_.end() && free_memory.offset + free_memory.size == next->offset;
+    if(merge_previous && merge_next){
+        std::prev(next)->size += free_memory.size + next->size;
+        list_.erase(next);
+    }
+    else if(merge_previous){
+        std::prev(next)->size += free_memory.size;
+    }
+    else if(merge_next){
+        next->offset = free_memory.offset;
+        next->size  += free_memory.size;
+    }
+    else{
+        list_.insert(next, free_memory);
+    }
+}
+}
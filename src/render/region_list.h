@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace render{
+struct Region{
+    size_t offset;
+    size_t size;
+    // Only Meaningful For SuballocatedBuffer Regions
+    uint32_t page = 0;
+};
+// Free Ranges Of One Allocation, Kept Sorted By Offset; Has No Vulkan Dependency So It Can Be Tested On Its Own
+class RegionList{
+public:
+    RegionList();
+    RegionList(size_t offset, size_t size);
+    
+    bool GetRegion(size_t size, size_t alignment, Region* acquired_region);
+    void FreeRegion(Region free_memory);
+    
+    size_t FreeBytes();
+    size_t LargestFreeRegion();
+    // Share Of Free Memory Outside The Largest Free Region, Zero When Free Memory Is Contiguous
+    float  Fragmentation();
+    
+private:
+    std::vector<Region> list_;
+};
+}
@@ -3,17 +3,28 @@
 
 #include "render/swapchain.h"
 #include "render/render_buffer.h"
+#include "render/frame_graph.h"
 
 #include "render/descriptor.h"
+#include "render/bindless.h"
 #include "render/pipeline.h"
+#include "render/shader_compiler.h"
+#include "render/shader_reflection.h"
 
+#include "render/resource_state.h"
+#include "render/memory_budget.h"
 #include "render/buffer.h"
+#include "render/defragmenter.h"
 #include "render/texture.h"
 
 #include "render/mesh.h"
+#include "render/mesh_streaming.h"
+#include "render/draw_queue.h"
 
 #include "render/command.h"
+#include "render/gpu_profiler.h"
 
 #include "render/staging.h"
+#include "render/texture_streaming.h"
 
 #include "render/camera.h"
@@ -48,18 +48,15 @@ public:
         
     VkRenderPass vk_render_pass;
 };
+// Attachments Are Expected In Their Attachment Layouts, Transitions Around The Pass Come From The Frame Graph
 class RenderBuffer{
 public:
-    RenderBuffer(Swapchain* swapchain);
+    RenderBuffer(Swapchain* swapchain, VkImageView vk_depth_image_view);
     ~RenderBuffer();
     
     void Begin(VkCommandBuffer vk_command_buffer, Swapchain* swapchain, uint32_t swapchain_image_index);
     
-    void CreateDepthImageAndView();
-    
     ImageExtent extent;
-    VmaAllocation vma_depth_allocation;
-    VkImage     vk_depth_image;
     VkImageView vk_depth_image_view;
     
     VkRenderPass vk_render_pass;
@@ -0,0 +1,166 @@
+#include "render/resource_state.h"
+#include "render/texture.h"
+#include "render/buffer.h"
+
+namespace render{
+ResourceState AccessState(ResourceAccess access, uint32_t queue_family_index){
+    switch(access){
+        case RESOURCE_ACCESS_TRANSFER_READ:
+            return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_READ_BIT, queue_family_index, false };
+        case RESOURCE_ACCESS_TRANSFER_WRITE:
+            return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, queue_family_index, true };
+        case RESOURCE_ACCESS_SHADER_READ:
+            return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                     VK_ACCESS_SHADER_READ_BIT, queue_family_index, false };
+        case RESOURCE_ACCESS_VERTEX_INPUT_READ:
+            return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                     VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, queue_family_index, false };
+        case RESOURCE_ACCESS_COLOR_ATTACHMENT_WRITE:
+            return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                     queue_family_index, true };
+        case RESOURCE_ACCESS_DEPTH_ATTACHMENT_WRITE:
+            return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                     VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                     queue_family_index, true };
+        case RESOURCE_ACCESS_DEPTH_ATTACHMENT_READ:
+            return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                     VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                     VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, queue_family_index, false };
+        case RESOURCE_ACCESS_PRESENT:
+        default:
+            return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                     queue_family_index, false };
+    }
+}
+
+ResourceBarrierStatistics resource_barrier_statistics{};
+void ResourceBarrierStatistics::Reset(){
+    barrier_count        = 0;
+    barrier_batch_count  = 0;
+    elided_barrier_count = 0;
+}
+
+// Reads After Reads In The Same Layout And On The Same Queue Only Widen The Tracked Stages
+bool BarrierBatch::NeedsBarrier(ResourceState* state, const ResourceState& target){
+    if(state->layout == target.layout && !state->written && !target.written &&
+       (state->queue_family_index == target.queue_family_index ||
+        state->queue_family_index == VK_QUEUE_FAMILY_IGNORED)){
+        state->stage_mask  |= target.stage_mask;
+        state->access_mask |= target.access_mask;
+        state->queue_family_index = target.queue_family_index;
+        resource_barrier_statistics.elided_barrier_count++;
+        return false;
+    }
+    return true;
+}
+
+void BarrierBatch::Transition(Texture* texture, ResourceAccess access, uint32_t base_mip_level, uint32_t level_count){
+    const ResourceState target = AccessState(access, render::context.graphics_queue.vk_family_index);
+    if(level_count == VK_REMAINING_MIP_LEVELS){
+        level_count = texture->mip_levels - base_mip_level;
+    }
+    for(uint32_t layer = 0; layer < texture->array_layers; layer++){
+        for(uint32_t mip = base_mip_level; mip < base_mip_level + level_count; mip++){
+            ResourceState* state = &texture->subresource_states[layer * texture->mip_levels + mip];
+            if(!NeedsBarrier(state, target)){
+                continue;
+            }
+            const bool ownership_transfer = state->queue_family_index != VK_QUEUE_FAMILY_IGNORED &&
+                                            state->queue_family_index != target.queue_family_index;
+            const uint32_t source_queue_family_index      = ownership_transfer ? state->queue_family_index : VK_QUEUE_FAMILY_IGNORED;
+            const uint32_t destination_queue_family_index = ownership_transfer ? target.queue_family_index : VK_QUEUE_FAMILY_IGNORED;
+
+            // Consecutive Mips Of One Layer Making The Same Transition Share A Barrier
+            if(!image_barriers.empty()){
+                VkImageMemoryBarrier& previous = image_barriers.back();
+                if(previous.image == texture->vk_image &&
+                   previous.oldLayout == state->layout && previous.newLayout == target.layout &&
+                   previous.subresourceRange.baseArrayLayer == layer &&
+                   previous.subresourceRange.baseMipLevel + previous.subresourceRange.levelCount == mip &&
+                   previous.srcAccessMask == (state->written ? state->access_mask : 0) &&
+                   previous.dstAccessMask == target.access_mask &&
+                   previous.srcQueueFamilyIndex == source_queue_family_index &&
+                   previous.dstQueueFamilyIndex == destination_queue_family_index){
+                    previous.subresourceRange.levelCount++;
+                    source_stage_mask      |= state->stage_mask;
+                    destination_stage_mask |= target.stage_mask;
+                    *state = target;
+                    continue;
+                }
+            }
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.pNext = nullptr;
+            barrier.srcAccessMask = state->written ? state->access_mask : 0;
+            barrier.dstAccessMask = target.access_mask;
+            barrier.oldLayout = state->layout;
+            barrier.newLayout = target.layout;
+            barrier.srcQueueFamilyIndex = source_queue_family_index;
+            barrier.dstQueueFamilyIndex = destination_queue_family_index;
+            barrier.image = texture->vk_image;
+            barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel   = mip;
+            barrier.subresourceRange.levelCount     = 1;
+            barrier.subresourceRange.baseArrayLayer = layer;
+            barrier.subresourceRange.layerCount     = 1;
+            image_barriers.emplace_back(barrier);
+
+            source_stage_mask      |= state->stage_mask;
+            destination_stage_mask |= target.stage_mask;
+            *state = target;
+        }
+    }
+}
+void BarrierBatch::Transition(Buffer* buffer, ResourceAccess access){
+    const ResourceState target = AccessState(access, render::context.graphics_queue.vk_family_index);
+    ResourceState* state = &buffer->state;
+    // A Buffer Never Touched By The Device Has Nothing To Wait On
+    if(state->access_mask == 0 && !state->written){
+        *state = target;
+        resource_barrier_statistics.elided_barrier_count++;
+        return;
+    }
+    if(!NeedsBarrier(state, target)){
+        return;
+    }
+    const bool ownership_transfer = state->queue_family_index != VK_QUEUE_FAMILY_IGNORED &&
+                                    state->queue_family_index != target.queue_family_index;
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+    barrier.srcAccessMask = state->written ? state->access_mask : 0;
+    barrier.dstAccessMask = target.access_mask;
+    barrier.srcQueueFamilyIndex = ownership_transfer ? state->queue_family_index : VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = ownership_transfer ? target.queue_family_index : VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer->vk_buffer;
+    barrier.offset = 0;
+    barrier.size   = VK_WHOLE_SIZE;
+    buffer_barriers.emplace_back(barrier);
+
+    source_stage_mask      |= state->stage_mask;
+    destination_stage_mask |= target.stage_mask;
+    *state = target;
+}
+
+void BarrierBatch::Flush(VkCommandBuffer vk_command_buffer){
+    if(image_barriers.empty() && buffer_barriers.empty()){
+        return;
+    }
+    vkCmdPipelineBarrier(vk_command_buffer, source_stage_mask, destination_stage_mask, 0,
+                         0, nullptr,
+                         (uint32_t)buffer_barriers.size(), buffer_barriers.data(),
+                         (uint32_t)image_barriers.size(),  image_barriers.data());
+    resource_barrier_statistics.barrier_count += (uint32_t)(image_barriers.size() + buffer_barriers.size());
+    resource_barrier_statistics.barrier_batch_count++;
+
+    image_barriers.clear();
+    buffer_barriers.clear();
+    source_stage_mask      = 0;
+    destination_stage_mask = 0;
+}
+}
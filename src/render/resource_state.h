@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "render/context.h"
+
+namespace render{
+class Texture;
+class Buffer;
+
+enum ResourceAccess{
+    RESOURCE_ACCESS_TRANSFER_READ,
+    RESOURCE_ACCESS_TRANSFER_WRITE,
+    RESOURCE_ACCESS_SHADER_READ,
+    RESOURCE_ACCESS_VERTEX_INPUT_READ,
+    RESOURCE_ACCESS_COLOR_ATTACHMENT_WRITE,
+    RESOURCE_ACCESS_DEPTH_ATTACHMENT_WRITE,
+    RESOURCE_ACCESS_DEPTH_ATTACHMENT_READ,
+    RESOURCE_ACCESS_PRESENT,
+};
+// Last Known Use Of A Buffer Or Image Subresource, Layout Is Ignored For Buffers
+struct ResourceState{
+    VkImageLayout        layout      = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stage_mask  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    VkAccessFlags        access_mask = 0;
+    uint32_t             queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+    bool                 written = false;
+};
+ResourceState AccessState(ResourceAccess access, uint32_t queue_family_index);
+
+struct ResourceBarrierStatistics{
+    std::atomic<uint32_t> barrier_count       = 0;
+    std::atomic<uint32_t> barrier_batch_count = 0;
+    std::atomic<uint32_t> elided_barrier_count = 0;
+
+    void Reset();
+};
+extern ResourceBarrierStatistics resource_barrier_statistics;
+
+// Collects Transitions Against Tracked State And Issues Them As One vkCmdPipelineBarrier,
+// Dropping Those Already Satisfied And Merging Adjacent Mip Levels Of An Image
+class BarrierBatch{
+public:
+    void Transition(Texture* texture, ResourceAccess access,
+                    uint32_t base_mip_level = 0, uint32_t level_count = VK_REMAINING_MIP_LEVELS);
+    void Transition(Buffer* buffer, ResourceAccess access);
+    void Flush(VkCommandBuffer vk_command_buffer);
+
+    VkPipelineStageFlags source_stage_mask      = 0;
+    VkPipelineStageFlags destination_stage_mask = 0;
+    std::vector<VkImageMemoryBarrier>  image_barriers{};
+    std::vector<VkBufferMemoryBarrier> buffer_barriers{};
+
+private:
+    bool NeedsBarrier(ResourceState* state, const ResourceState& target);
+};
+}
@@ -0,0 +1,131 @@
+#include "render/shader_compiler.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#include "glslang/Public/ShaderLang.h"
+#include "glslang/Public/ResourceLimits.h"
+#include "SPIRV/GlslangToSpv.h"
+#include "glslang/build_info.h"
+
+namespace render{
+static EShLanguage GlslangStage(ShaderStage stage){
+    switch(stage){
+        case SHADER_STAGE_FRAGMENT:
+            return EShLangFragment;
+        case SHADER_STAGE_VERTEX:
+        default:
+            return EShLangVertex;
+    }
+}
+
+ShaderCompiler shader_compiler{};
+void ShaderCompiler::Initialize(const char* cache_directory){
+    this->cache_directory = cache_directory;
+    std::error_code error_code;
+    std::filesystem::create_directories(this->cache_directory, error_code);
+    glslang::InitializeProcess();
+}
+void ShaderCompiler::Terminate(){
+    glslang::FinalizeProcess();
+}
+
+uint64_t ShaderCompiler::CacheKey(ShaderStage stage, size_t buffer_size, const char* buffer,
+                                  const ShaderCompileOptions& options){
+    const uint32_t compiler_version[3] = {
+        GLSLANG_VERSION_MAJOR, GLSLANG_VERSION_MINOR, GLSLANG_VERSION_PATCH
+    };
+    uint64_t hash = HashBytes(compiler_version, sizeof(compiler_version));
+    hash = HashValue(stage, hash);
+    hash = HashValue(options.optimize, hash);
+    hash = HashValue(options.strip_debug_info, hash);
+    for(const std::string& define : options.defines){
+        hash = HashBytes(define.data(), define.size() + 1, hash);
+    }
+    return HashBytes(buffer, buffer_size, hash);
+}
+
+std::vector<uint32_t> ShaderCompiler::CompileGlsl(ShaderStage stage, size_t buffer_size, const char* buffer,
+                                                  const ShaderCompileOptions& options){
+    uint64_t cache_key = CacheKey(stage, buffer_size, buffer, options);
+    std::vector<uint32_t> spirv{};
+    if(LoadCachedSpirv(cache_key, &spirv)){
+        return spirv;
+    }
+
+    std::string preamble{};
+    for(const std::string& define : options.defines){
+        preamble += "#define " + define + "\n";
+    }
+
+    EShLanguage language = GlslangStage(stage);
+    glslang::TShader shader(language);
+    const int buffer_length = (int)buffer_size;
+    shader.setStringsWithLengths(&buffer, &buffer_length, 1);
+    shader.setPreamble(preamble.c_str());
+    shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+    shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_2);
+    shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_5);
+
+    const EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
+    if(!shader.parse(GetDefaultResources(), 100, false, messages)){
+        throw std::runtime_error(std::string("FAILED TO COMPILE GLSL -> ") + shader.getInfoLog());
+    }
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if(!program.link(messages)){
+        throw std::runtime_error(std::string("FAILED TO LINK GLSL -> ") + program.getInfoLog());
+    }
+
+    glslang::SpvOptions spv_options{};
+    spv_options.disableOptimizer = !options.optimize;
+    spv_options.optimizeSize     =  options.optimize;
+    spv_options.stripDebugInfo   =  options.strip_debug_info;
+    glslang::GlslangToSpv(*program.getIntermediate(language), spirv, &spv_options);
+
+    StoreCachedSpirv(cache_key, spirv);
+    return spirv;
+}
+
+void ShaderCompiler::AwaitShader(Shader* shader){
+    std::unique_lock<std::mutex> lock(compilation_mutex);
+    compilation_condition_variable.wait(lock, [shader]{
+        return shader->IsReady();
+    });
+}
+
+bool ShaderCompiler::LoadCachedSpirv(uint64_t cache_key, std::vector<uint32_t>* spirv){
+    char filename[32];
+    snprintf(filename, sizeof(filename), "/%016llx.spv", (unsigned long long)cache_key);
+    std::ifstream file(cache_directory + filename, std::ios::binary);
+    if(!file.is_open()){
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    size_t size = file.tellg();
+    file.seekg(0);
+    if(size == 0 || size % sizeof(uint32_t) != 0){
+        return false;
+    }
+    spirv->resize(size / sizeof(uint32_t));
+    file.read((char*)spirv->data(), size);
+    return (bool)file;
+}
+// Written To A Temporary File First So A Concurrent Reader Never Sees A Partial Module
+void ShaderCompiler::StoreCachedSpirv(uint64_t cache_key, const std::vector<uint32_t>& spirv){
+    char filename[32];
+    snprintf(filename, sizeof(filename), "/%016llx.spv", (unsigned long long)cache_key);
+    std::string filepath = cache_directory + filename;
+    std::string temporary_filepath =
+    filepath + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporary_filepath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()){
+            return;
+        }
+        file.write((const char*)spirv.data(), spirv.size() * sizeof(uint32_t));
+    }
+    std::error_code error_code;
+    std::filesystem::rename(temporary_filepath, filepath, error_code);
+}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "render/pipeline.h"
+
+namespace render{
+// Compiles GLSL To SPIR-V Through The Vendored glslang, Caching Results On Disk By
+// Hash Of Stage, Source, Defines, Options And Compiler Version
+class ShaderCompiler{
+public:
+    void Initialize(const char* cache_directory = "shader_cache");
+    void Terminate();
+
+    uint64_t CacheKey(ShaderStage stage, size_t buffer_size, const char* buffer,
+                      const ShaderCompileOptions& options);
+    std::vector<uint32_t> CompileGlsl(ShaderStage stage, size_t buffer_size, const char* buffer,
+                                      const ShaderCompileOptions& options);
+
+    void AwaitShader(Shader* shader);
+
+    bool LoadCachedSpirv (uint64_t cache_key, std::vector<uint32_t>* spirv);
+    void StoreCachedSpirv(uint64_t cache_key, const std::vector<uint32_t>& spirv);
+
+    std::string cache_directory;
+
+    std::mutex compilation_mutex;
+    std::condition_variable compilation_condition_variable;
+};
+extern ShaderCompiler shader_compiler;
+}
@@ -0,0 +1,131 @@
+#include "render/shader_reflection.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "spirv_reflect.h"
+
+namespace render{
+void ReflectSpirv(size_t code_size, const uint32_t* code, ShaderReflection* reflection){
+    SpvReflectShaderModule module{};
+    if(spvReflectCreateShaderModule(code_size, code, &module) != SPV_REFLECT_RESULT_SUCCESS){
+        throw std::runtime_error("FAILED TO REFLECT SPIRV");
+    }
+    *reflection = {};
+    reflection->stage_flags = (VkShaderStageFlags)module.shader_stage;
+
+    uint32_t set_count = 0;
+    spvReflectEnumerateDescriptorSets(&module, &set_count, nullptr);
+    std::vector<SpvReflectDescriptorSet*> sets(set_count);
+    spvReflectEnumerateDescriptorSets(&module, &set_count, sets.data());
+    for(SpvReflectDescriptorSet* set : sets){
+        if(reflection->descriptor_sets.size() <= set->set){
+            reflection->descriptor_sets.resize(set->set + 1);
+        }
+        for(uint32_t i = 0; i < set->binding_count; i++){
+            SpvReflectDescriptorBinding* binding = set->bindings[i];
+            reflection->descriptor_sets[set->set].push_back({
+                binding->binding, (VkDescriptorType)binding->descriptor_type,
+                binding->count, reflection->stage_flags, nullptr
+            });
+        }
+    }
+
+    uint32_t block_count = 0;
+    spvReflectEnumeratePushConstantBlocks(&module, &block_count, nullptr);
+    std::vector<SpvReflectBlockVariable*> blocks(block_count);
+    spvReflectEnumeratePushConstantBlocks(&module, &block_count, blocks.data());
+    for(SpvReflectBlockVariable* block : blocks){
+        reflection->push_constant_ranges.push_back({ reflection->stage_flags, block->offset, block->size });
+    }
+
+    if(module.shader_stage == SPV_REFLECT_SHADER_STAGE_VERTEX_BIT){
+        uint32_t input_count = 0;
+        spvReflectEnumerateInputVariables(&module, &input_count, nullptr);
+        std::vector<SpvReflectInterfaceVariable*> inputs(input_count);
+        spvReflectEnumerateInputVariables(&module, &input_count, inputs.data());
+        for(SpvReflectInterfaceVariable* input : inputs){
+            if(input->decoration_flags & SPV_REFLECT_DECORATION_BUILT_IN){
+                continue;
+            }
+            reflection->vertex_inputs.push_back({ input->location, (VkFormat)input->format });
+        }
+        std::sort(reflection->vertex_inputs.begin(), reflection->vertex_inputs.end(),
+                  [](const ReflectedVertexInput& a, const ReflectedVertexInput& b){ return a.location < b.location; });
+    }
+    spvReflectDestroyShaderModule(&module);
+}
+
+// Bindings Shared Between Stages Are Merged By Set And Binding, Push Constants Into One Range
+ShaderReflection MergeShaderReflections(const std::vector<const ShaderReflection*>& reflections){
+    ShaderReflection merged{};
+    VkShaderStageFlags push_constant_stage_flags = 0;
+    uint32_t push_constant_begin = UINT32_MAX;
+    uint32_t push_constant_end   = 0;
+    for(const ShaderReflection* reflection : reflections){
+        merged.stage_flags |= reflection->stage_flags;
+        if(merged.descriptor_sets.size() < reflection->descriptor_sets.size()){
+            merged.descriptor_sets.resize(reflection->descriptor_sets.size());
+        }
+        for(size_t set = 0; set < reflection->descriptor_sets.size(); set++){
+            for(const DescriptorBinding& binding : reflection->descriptor_sets[set]){
+                std::vector<DescriptorBinding>& merged_set = merged.descriptor_sets[set];
+                auto iterator = std::find_if(merged_set.begin(), merged_set.end(), [&binding](const DescriptorBinding& other){
+                    return other.binding == binding.binding;
+                });
+                if(iterator == merged_set.end()){
+                    merged_set.push_back(binding);
+                    continue;
+                }
+                if(iterator->descriptorType != binding.descriptorType){
+                    throw std::runtime_error("SHADER STAGES DISAGREE ON DESCRIPTOR TYPE");
+                }
+                iterator->stageFlags     |= binding.stageFlags;
+                iterator->descriptorCount = std::max(iterator->descriptorCount, binding.descriptorCount);
+            }
+        }
+        for(const VkPushConstantRange& range : reflection->push_constant_ranges){
+            push_constant_stage_flags |= range.stageFlags;
+            push_constant_begin = std::min(push_constant_begin, range.offset);
+            push_constant_end   = std::max(push_constant_end,   range.offset + range.size);
+        }
+        if(reflection->stage_flags & VK_SHADER_STAGE_VERTEX_BIT){
+            merged.vertex_inputs = reflection->vertex_inputs;
+        }
+    }
+    for(std::vector<DescriptorBinding>& set : merged.descriptor_sets){
+        std::sort(set.begin(), set.end(), [](const DescriptorBinding& a, const DescriptorBinding& b){
+            return a.binding < b.binding;
+        });
+    }
+    if(push_constant_stage_flags != 0){
+        merged.push_constant_ranges.push_back({
+            push_constant_stage_flags, push_constant_begin, push_constant_end - push_constant_begin
+        });
+    }
+    return merged;
+}
+
+uint32_t FormatSize(VkFormat format){
+    switch(format){
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_UINT:
+            return 4;
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_UINT:
+            return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32_UINT:
+            return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+            return 16;
+        default:
+            throw std::runtime_error("UNSUPPORTED VERTEX INPUT FORMAT");
+    }
+}
+}
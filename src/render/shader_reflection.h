@@ -0,0 +1,18 @@
+#pragma once
+#include "render/descriptor.h"
+
+namespace render{
+struct ReflectedVertexInput{
+    uint32_t location;
+    VkFormat format;
+};
+struct ShaderReflection{
+    VkShaderStageFlags stage_flags = 0;
+    std::vector<std::vector<DescriptorBinding>> descriptor_sets;
+    std::vector<VkPushConstantRange>  push_constant_ranges;
+    std::vector<ReflectedVertexInput> vertex_inputs;
+};
+void ReflectSpirv(size_t code_size, const uint32_t* code, ShaderReflection* reflection);
+ShaderReflection MergeShaderReflections(const std::vector<const ShaderReflection*>& reflections);
+uint32_t FormatSize(VkFormat format);
+}
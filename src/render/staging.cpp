@@ -1,8 +1,28 @@
 #include "staging.h"
+#include "render/gpu_profiler.h"
+#include "metrics.h"
+
+#include <algorithm>
 
 namespace render{
 StagingManager staging_manager{};
-void StagingManager::Initialize(){
+void StagingManager::Initialize(bool allow_direct_upload){
+    // A BAR Window Of 256 MB Or Less Is Too Small To Hold Geometry, Resizable BAR And UMA Expose The Whole Heap
+    const VkPhysicalDeviceMemoryProperties* memory_properties;
+    vmaGetMemoryProperties(render::context.allocator, &memory_properties);
+    const VkMemoryPropertyFlags direct_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    for(uint32_t i = 0; i < memory_properties->memoryTypeCount; i++){
+        const VkMemoryType& memory_type = memory_properties->memoryTypes[i];
+        if((memory_type.propertyFlags & direct_flags) == direct_flags &&
+           memory_properties->memoryHeaps[memory_type.heapIndex].size > 256 * 1024 * 1024){
+            direct_upload_supported = true;
+        }
+    }
+    direct_upload_enabled = direct_upload_supported && allow_direct_upload;
+    if(direct_upload_enabled){
+        staging_buffer_size = std::min(staging_buffer_size, direct_upload_staging_buffer_size);
+    }
+    
     VkCommandPoolCreateInfo pool_create_info{};
     pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     pool_create_info.pNext = nullptr;
@@ -20,11 +40,12 @@ void StagingManager::Initialize(){
     vkAllocateCommandBuffers(render::context.vk_device, &allocate_info, &vk_command_buffer);
     
     mapped_pointer = staging_buffer.Initialize({
-        1000000000,
+        staging_buffer_size,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VMA_MEMORY_USAGE_AUTO,
         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-        VMA_ALLOCATION_CREATE_MAPPED_BIT});
+        VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        MEMORY_CATEGORY_STAGING});
     
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -33,42 +54,106 @@ void StagingManager::Initialize(){
     begin_info.pInheritanceInfo = nullptr;
     
     vkBeginCommandBuffer(vk_command_buffer, &begin_info);
+    recording = true;
     
     upload_fence.Initialize(Fence::InitializeUnsignaled);
 }
+// VMA Still Falls Back To Plain Device Local Memory Per Allocation When The Host Visible Heap Is Exhausted
+BufferInfo StagingManager::DirectUploadBufferInfo(BufferInfo info){
+    if(!direct_upload_enabled){
+        return info;
+    }
+    info.memory_usage  = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    info.create_flags |= VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                         VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+                         VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    return info;
+}
 void StagingManager::Terminate(){
     upload_fence.Terminate();
     vkDestroyCommandPool(render::context.vk_device, vk_command_pool, nullptr);
     staging_buffer.Terminate();
 }
 
+// After A Submit The Next Upload Waits For It, Then Reuses The Command Buffer And Staging Memory From The Start
+void StagingManager::BeginUpload(){
+    if(recording){
+        return;
+    }
+    AwaitUploadCompletion();
+    render::command_manager.ResetFence(&upload_fence);
+    vkResetCommandBuffer(vk_command_buffer, 0);
+    
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pNext = nullptr;
+    begin_info.pInheritanceInfo = nullptr;
+    vkBeginCommandBuffer(vk_command_buffer, &begin_info);
+    
+    staging_buffer_offset = 0;
+    recording = true;
+}
+size_t StagingManager::Available(){
+    if(!recording){
+        return staging_buffer_size;
+    }
+    return staging_buffer_size - staging_buffer_offset;
+}
+
+// One GPU Zone Spans Every Copy Recorded Into The Batch
+void StagingManager::BeginUploadZone(){
+    if(upload_gpu_zone == UINT32_MAX){
+        upload_gpu_zone = gpu_profiler.BeginUploadZone(vk_command_buffer, "Upload Batch");
+    }
+}
 void* StagingManager::UploadToBuffer(size_t upload_size, size_t offset, Buffer* buffer){
+    PROFILE_FUNCTION();
+    // Mapped Destinations Are Written In Place, Nothing Is Copied On The GPU
+    if(direct_upload_enabled && buffer->mapped_pointer != nullptr){
+        if(!buffer->host_coherent){
+            direct_writes.push_back({ buffer, Region{ offset, upload_size } });
+        }
+        static core::MetricCounter* direct_byte_counter = core::metrics.Counter("direct_bytes_uploaded");
+        direct_byte_counter->Add(upload_size);
+        return buffer->mapped_pointer + offset;
+    }
+    BeginUpload();
+    if(upload_size > Available()){
+        throw std::runtime_error("STAGING BUFFER FULL");
+    }
+    BeginUploadZone();
     char* buffer_pointer = mapped_pointer + staging_buffer_offset;
     VkBufferCopy buffer_copy{};
     buffer_copy.size = upload_size;
     buffer_copy.srcOffset = staging_buffer_offset;
     buffer_copy.dstOffset = offset;
     
+    // Copies Within One Upload Target Disjoint Allocations, So Only The First Waits On Earlier Use
+    if(std::find(uploaded_buffers.begin(), uploaded_buffers.end(), buffer) == uploaded_buffers.end()){
+        BarrierBatch acquire_barriers{};
+        acquire_barriers.Transition(buffer, RESOURCE_ACCESS_TRANSFER_WRITE);
+        acquire_barriers.Flush(vk_command_buffer);
+        uploaded_buffers.emplace_back(buffer);
+    }
     vkCmdCopyBuffer(vk_command_buffer, staging_buffer.vk_buffer, buffer->vk_buffer, 1, &buffer_copy);
+    static core::MetricCounter* uploaded_byte_counter = core::metrics.Counter("staging_bytes_uploaded");
+    uploaded_byte_counter->Add(upload_size);
     
     staging_buffer_offset += upload_size;
     return buffer_pointer;
 }
-void* StagingManager::UploadToImage (size_t upload_size, Texture* texture){
-    void* buffer_pointer = mapped_pointer + staging_buffer_offset;
-    {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.srcQueueFamilyIndex = 0;
-        barrier.dstQueueFamilyIndex = 0;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.image = texture->vk_image;
-        vkCmdPipelineBarrier(vk_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_DEPENDENCY_BY_REGION_BIT, 0, nullptr, 0, nullptr, 1, &barrier);
+void* StagingManager::UploadToImage (size_t upload_size, Texture* texture, uint32_t mip_level){
+    PROFILE_FUNCTION();
+    BeginUpload();
+    // Buffer To Image Copies Need Offsets Aligned To The Texel Size
+    staging_buffer_offset = (staging_buffer_offset + 15) & ~15u;
+    if(upload_size > Available()){
+        throw std::runtime_error("STAGING BUFFER FULL");
     }
+    BeginUploadZone();
+    void* buffer_pointer = mapped_pointer + staging_buffer_offset;
+    image_acquire_barriers.Transition(texture, RESOURCE_ACCESS_TRANSFER_WRITE, mip_level, 1);
     
     VkBufferImageCopy copy{};
     copy.bufferOffset = staging_buffer_offset;
@@ -78,45 +163,144 @@ void* StagingManager::UploadToImage (size_t upload_size, Texture* texture){
     copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     copy.imageSubresource.baseArrayLayer = 0;
     copy.imageSubresource.layerCount = 1;
-    copy.imageSubresource.mipLevel = 0;
+    copy.imageSubresource.mipLevel = mip_level;
     copy.imageOffset = {0, 0, 0};
-    copy.imageExtent = {texture->image_extent.width, texture->image_extent.height, 1};
+    copy.imageExtent = {std::max(texture->image_extent.width  >> mip_level, 1u),
+                        std::max(texture->image_extent.height >> mip_level, 1u), 1};
     
-    vkCmdCopyBufferToImage(vk_command_buffer, staging_buffer.vk_buffer, 
-                           texture->vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+    image_copies.emplace_back(texture, copy);
     
-    {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.srcQueueFamilyIndex = 0;
-        barrier.dstQueueFamilyIndex = 0;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.image = texture->vk_image;
-        vkCmdPipelineBarrier(vk_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_DEPENDENCY_BY_REGION_BIT, 0, nullptr, 0, nullptr, 1, &barrier);
+    if(std::find(uploaded_textures.begin(), uploaded_textures.end(), texture) == uploaded_textures.end()){
+        uploaded_textures.emplace_back(texture);
     }
+    static core::MetricCounter* uploaded_byte_counter = core::metrics.Counter("staging_bytes_uploaded");
+    uploaded_byte_counter->Add(upload_size);
     
     staging_buffer_offset += upload_size;
     return buffer_pointer;
 }
 
 
+// Sources Are Only Read, So Earlier Vertex Reads Of Them Need No Barrier
+void StagingManager::CopyBuffer(Buffer* source, Buffer* destination, const std::vector<VkBufferCopy>& copies){
+    PROFILE_FUNCTION();
+    BeginUpload();
+    BeginUploadZone();
+    if(std::find(uploaded_buffers.begin(), uploaded_buffers.end(), destination) == uploaded_buffers.end()){
+        BarrierBatch acquire_barriers{};
+        acquire_barriers.Transition(destination, RESOURCE_ACCESS_TRANSFER_WRITE);
+        acquire_barriers.Flush(vk_command_buffer);
+        uploaded_buffers.emplace_back(destination);
+    }
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.pNext = nullptr;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(vk_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &barrier, 0, nullptr, 0, nullptr);
+    vkCmdCopyBuffer(vk_command_buffer, source->vk_buffer, destination->vk_buffer, (uint32_t)copies.size(), copies.data());
+}
+// Frames Still Sampling The Source Finish Before Its Transition, Later Ones Start After Its Release
+void StagingManager::CopyImage(Texture* source, uint32_t source_mip_level, Texture* destination, uint32_t destination_mip_level){
+    PROFILE_FUNCTION();
+    BeginUpload();
+    BeginUploadZone();
+    image_acquire_barriers.Transition(source,      RESOURCE_ACCESS_TRANSFER_READ,  source_mip_level,      1);
+    image_acquire_barriers.Transition(destination, RESOURCE_ACCESS_TRANSFER_WRITE, destination_mip_level, 1);
+    
+    VkImageCopy copy{};
+    copy.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy.srcSubresource.mipLevel       = source_mip_level;
+    copy.srcSubresource.baseArrayLayer = 0;
+    copy.srcSubresource.layerCount     = 1;
+    copy.dstSubresource = copy.srcSubresource;
+    copy.dstSubresource.mipLevel = destination_mip_level;
+    copy.srcOffset = {0, 0, 0};
+    copy.dstOffset = {0, 0, 0};
+    copy.extent = {std::max(source->image_extent.width  >> source_mip_level, 1u),
+                   std::max(source->image_extent.height >> source_mip_level, 1u), 1};
+    image_to_image_copies.push_back({ source, destination, copy });
+    
+    for(Texture* texture : {source, destination}){
+        if(std::find(uploaded_textures.begin(), uploaded_textures.end(), texture) == uploaded_textures.end()){
+            uploaded_textures.emplace_back(texture);
+        }
+    }
+}
+
 void StagingManager::SubmitUpload(SubmitInfo submit_info){
-    vkEndCommandBuffer(vk_command_buffer);
+    PROFILE_FUNCTION();
+    // Host Writes Before vkQueueSubmit Are Visible To It Once Flushed
+    for(const auto& [buffer, region] : direct_writes){
+        vmaFlushAllocation(render::context.allocator, buffer->vma_allocation, region.offset, region.size);
+    }
+    direct_writes.clear();
+    if(!recording){
+        return;
+    }
+    // Consecutive Levels Of One Texture Go Out As A Single Copy Command
+    image_acquire_barriers.Flush(vk_command_buffer);
+    std::vector<VkBufferImageCopy> regions{};
+    for(size_t i = 0; i < image_copies.size(); i++){
+        regions.push_back(image_copies[i].second);
+        if(i + 1 < image_copies.size() && image_copies[i + 1].first == image_copies[i].first){
+            continue;
+        }
+        vkCmdCopyBufferToImage(vk_command_buffer, staging_buffer.vk_buffer, image_copies[i].first->vk_image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+        regions.clear();
+    }
+    image_copies.clear();
+    for(const ImageCopy& image_copy : image_to_image_copies){
+        vkCmdCopyImage(vk_command_buffer,
+                       image_copy.source->vk_image,      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image_copy.destination->vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &image_copy.copy);
+    }
+    image_to_image_copies.clear();
+    for(Texture* texture : uploaded_textures){
+        release_barriers.Transition(texture, RESOURCE_ACCESS_SHADER_READ);
+    }
+    for(Buffer* buffer : uploaded_buffers){
+        release_barriers.Transition(buffer, RESOURCE_ACCESS_VERTEX_INPUT_READ);
+    }
+    release_barriers.Flush(vk_command_buffer);
+    uploaded_textures.clear();
+    uploaded_buffers.clear();
+    gpu_profiler.EndZone(vk_command_buffer, upload_gpu_zone);
+    upload_gpu_zone = UINT32_MAX;
+    
+    // SubmitAsync Ends The Command Buffer
+    recording = false;
+    upload_active_mutex.lock();
+    upload_active = true;
+    upload_active_mutex.unlock();
     submit_info.fence = &upload_fence;
     auto command_buffer = new CommandBuffer{};
     command_buffer->vk_command_buffer = vk_command_buffer;
     command_buffer->record_submission_complete = true;
     render::command_manager.SubmitAsync(submit_info, command_buffer);
 }
+bool StagingManager::IsUploadComplete(){
+    std::lock_guard<std::mutex> lock(upload_active_mutex);
+    if(!upload_active){
+        return true;
+    }
+    if(!upload_fence.submission_flag ||
+       vkGetFenceStatus(render::context.vk_device, upload_fence.vk_fence) != VK_SUCCESS){
+        return false;
+    }
+    upload_active = false;
+    gpu_profiler.ResolveUploads();
+    return true;
+}
 void StagingManager::AwaitUploadCompletion(){
+    PROFILE_FUNCTION();
     upload_active_mutex.lock();
     if(upload_active){
         render::command_manager.WaitForFence(&upload_fence);
         upload_active = false;
+        gpu_profiler.ResolveUploads();
     }
     upload_active_mutex.unlock();
 }
@@ -4,32 +4,70 @@
 #include "render/command.h"
 
 namespace render{
+struct ImageCopy{
+    Texture* source;
+    Texture* destination;
+    VkImageCopy copy;
+};
 class StagingManager{
 public:
-    void Initialize();
+    void Initialize(bool allow_direct_upload = true);
     void Terminate();
     
     template<typename T>
-    void* UploadToTBAllocation(SuballocatedBuffer template_buffer, TBAllocation<T> allocation){
-        return UploadToBuffer(allocation.count * sizeof(T), allocation.offset * sizeof(T), &template_buffer.buffer);
+    void* UploadToTBAllocation(SuballocatedBuffer& template_buffer, TBAllocation<T> allocation){
+        return UploadToBuffer(allocation.count * sizeof(T), allocation.offset * sizeof(T),
+                              template_buffer.GetBuffer(allocation.page));
     }
     void* UploadToBuffer(size_t upload_size, size_t offset, Buffer*  buffer);
-    void* UploadToImage (size_t upload_size, Texture* texture);
+    void* UploadToImage (size_t upload_size, Texture* texture, uint32_t mip_level = 0);
+    // Device Side Moves Between Disjoint Ranges, Ordered After Earlier Copies In The Batch
+    void  CopyBuffer(Buffer* source, Buffer* destination, const std::vector<VkBufferCopy>& copies);
+    // Same Sized Levels Of Two Images, The Source Is Back In Shader Reads Once The Batch Is Submitted
+    void  CopyImage(Texture* source, uint32_t source_mip_level, Texture* destination, uint32_t destination_mip_level);
+    void  BeginUpload();
+    void  BeginUploadZone();
+    // Bytes Left In The Current Batch
+    size_t Available();
     
     void SubmitUpload(SubmitInfo submit_info);
     void AwaitUploadCompletion();
+    // Non Blocking, For Callers That Poll Once Per Frame
+    bool IsUploadComplete();
+    
+    // Device Local Memory The Host Can Write Directly, As On ReBAR And UMA Devices; Buffers Created
+    // With DirectUploadBufferInfo Land There When It Exists And Skip The Staging Copy
+    bool direct_upload_supported = false;
+    bool direct_upload_enabled   = false;
+    BufferInfo DirectUploadBufferInfo(BufferInfo info);
     
     char* mapped_pointer = nullptr;
+    size_t   staging_buffer_size   = 1000000000;
+    // Used Instead When Direct Upload Is Enabled, Only Images And Buffers Outside Host Visible Memory Are Staged
+    size_t   direct_upload_staging_buffer_size = 128 * 1024 * 1024;
     uint32_t staging_buffer_offset = 0;
     Buffer staging_buffer{};
 
     VkCommandPool   vk_command_pool   = VK_NULL_HANDLE;
     VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+    bool recording = false;
 
     std::mutex upload_active_mutex;
     bool upload_active = false;
     bool upload_submission_flag = false;
     Fence upload_fence{};
+    
+    // Transitions To The Consuming State Are Deferred And Issued Together When The Upload Is Submitted
+    BarrierBatch release_barriers{};
+    std::vector<Texture*> uploaded_textures{};
+    std::vector<Buffer*>  uploaded_buffers{};
+    // Image Copies Are Recorded At Submit, After One Flush Of Every Level's Acquire Transition
+    BarrierBatch image_acquire_barriers{};
+    std::vector<std::pair<Texture*, VkBufferImageCopy>> image_copies{};
+    std::vector<ImageCopy> image_to_image_copies{};
+    // Non Coherent Ranges Written Directly, Flushed On The Next Submit
+    std::vector<std::pair<Buffer*, Region>> direct_writes{};
+    uint32_t upload_gpu_zone = UINT32_MAX;
 };
 extern StagingManager staging_manager;
 }
@@ -87,15 +87,74 @@ Swapchain::Swapchain(Window* window){
     
     surface_format_ = chosen_surface_format;
 }
+Swapchain::Swapchain(VkExtent2D extent, uint32_t image_count){
+    extent_ = extent;
+    surface_format_.format     = VK_FORMAT_B8G8R8A8_SRGB;
+    surface_format_.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    final_layout_ = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    
+    VkImageCreateInfo image_create_info{};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.pNext = nullptr;
+    image_create_info.flags = 0;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format    = surface_format_.format;
+    image_create_info.extent    = { extent.width, extent.height, 1 };
+    image_create_info.mipLevels   = 1;
+    image_create_info.arrayLayers = 1;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling  = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.usage   = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_create_info.queueFamilyIndexCount = 0;
+    image_create_info.pQueueFamilyIndices   = nullptr;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    
+    VmaAllocationCreateInfo allocation_create_info{};
+    allocation_create_info.usage = VMA_MEMORY_USAGE_AUTO;
+    
+    images_.resize(image_count);
+    offscreen_allocations_.resize(image_count);
+    VmaAllocationInfo allocation_info{};
+    for(uint32_t i = 0; i < image_count; i++){
+        VkResult vk_result = vmaCreateImage(render::context.allocator, &image_create_info, &allocation_create_info,
+                                            &images_[i], &offscreen_allocations_[i], &allocation_info);
+        if(vk_result != VK_SUCCESS){
+            throw std::runtime_error("FAILED TO CREATE OFFSCREEN IMAGE");
+        }
+        render::memory_budget.Track(MEMORY_CATEGORY_RENDER_TARGET, allocation_info.size);
+    }
+}
 Swapchain::~Swapchain(){
     for(VkImageView image_view : image_views){
         vkDestroyImageView(render::context.vk_device, image_view, nullptr);
     }
+    if(IsHeadless()){
+        for(uint32_t i = 0; i < images_.size(); i++){
+            VmaAllocationInfo allocation_info{};
+            vmaGetAllocationInfo(render::context.allocator, offscreen_allocations_[i], &allocation_info);
+            render::memory_budget.Untrack(MEMORY_CATEGORY_RENDER_TARGET, allocation_info.size);
+            vmaDestroyImage(render::context.allocator, images_[i], offscreen_allocations_[i]);
+        }
+        return;
+    }
     vkDestroySwapchainKHR(render::context.vk_device, vk_swapchain_, nullptr);
     vkDestroySurfaceKHR(render::context.vk_instance, vk_surface_, nullptr);
 }
 
+bool Swapchain::IsHeadless(){
+    return vk_swapchain_ == VK_NULL_HANDLE;
+}
+
 uint32_t Swapchain::AcquireImage(VkSemaphore semaphore, VkFence fence){
+    // Offscreen Images Are Handed Out Round Robin, Nothing Is Signaled So Callers Rely On Their Frame Fence
+    if(IsHeadless()){
+        std::lock_guard<std::mutex> lock(usage_mutex);
+        uint32_t image_index = next_offscreen_image_;
+        next_offscreen_image_ = (next_offscreen_image_ + 1) % (uint32_t)images_.size();
+        return image_index;
+    }
     usage_mutex.lock();
     uint32_t image_index;
     vkAcquireNextImageKHR(render::context.vk_device, vk_swapchain_, UINT64_MAX,
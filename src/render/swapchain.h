@@ -1,5 +1,6 @@
 #pragma once
 #include "render/context.h"
+#include "render/memory_budget.h"
 
 #include <mutex>
 
@@ -7,20 +8,28 @@ namespace render{
 class Swapchain{
 public:
     Swapchain(Window* window);
+    // Headless, Renders Into Offscreen Images With No Surface Or Presentation
+    Swapchain(VkExtent2D extent, uint32_t image_count);
     ~Swapchain();
     
     uint32_t AcquireImage(VkSemaphore semaphore, VkFence fence);
+    bool IsHeadless();
     
     void CreateImageViews();
     VkImageView* GetImageViews();
     
     std::mutex usage_mutex;
     
-    VkSurfaceKHR vk_surface_;
+    VkSurfaceKHR vk_surface_ = VK_NULL_HANDLE;
     VkSurfaceFormatKHR surface_format_;
     VkExtent2D extent_;
-    VkSwapchainKHR vk_swapchain_;
+    VkSwapchainKHR vk_swapchain_ = VK_NULL_HANDLE;
     std::vector<VkImage> images_;
     std::vector<VkImageView> image_views;
+    // Layout Images Are Left In At The End Of The Render Pass
+    VkImageLayout final_layout_ = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
+    std::vector<VmaAllocation> offscreen_allocations_;
+    uint32_t next_offscreen_image_ = 0;
 };
 }
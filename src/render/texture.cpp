@@ -1,4 +1,5 @@
 #include "render/texture.h"
+#include "render/bindless.h"
 
 namespace render{
 Texture::Texture(){};
@@ -15,7 +16,6 @@ void Texture::Initialize(TextureInfo info){
     
     image_create_info.format = VK_FORMAT_R8G8B8A8_SRGB;
     image_create_info.extent = *(VkExtent3D*)&image_extent;
-    image_create_info.mipLevels = 1;
     
     image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     image_create_info.queueFamilyIndexCount = 1;
@@ -23,93 +23,189 @@ void Texture::Initialize(TextureInfo info){
     
     image_create_info.tiling  = VK_IMAGE_TILING_OPTIMAL;
     image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
-    image_create_info.mipLevels   = 1;
+    image_create_info.mipLevels   = info.mip_levels;
     image_create_info.arrayLayers = 1;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-    vmaCreateImage(render::context.allocator, &image_create_info, &allocInfo, &vk_image, &vma_allocation, nullptr);
+    VmaAllocationInfo allocation_info{};
+    vmaCreateImage(render::context.allocator, &image_create_info, &allocInfo, &vk_image, &vma_allocation, &allocation_info);
+    allocation_size = allocation_info.size;
+    render::memory_budget.Track(MEMORY_CATEGORY_TEXTURE, allocation_size);
+    mip_levels   = image_create_info.mipLevels;
+    array_layers = image_create_info.arrayLayers;
+    subresource_states.assign(mip_levels * array_layers, ResourceState{});
     
-    VkImageSubresourceRange subresource_range{};
-    subresource_range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    subresource_range.layerCount = 1;
-    subresource_range.baseArrayLayer = 0;
-    subresource_range.levelCount = 1;
-    subresource_range.baseMipLevel = 0;
+    ImageViewInfo view_info{};
+    view_info.vk_image = vk_image;
+    view_info.format   = VK_FORMAT_R8G8B8A8_SRGB;
+    view_info.level_count = mip_levels;
+    vk_view = render::image_view_cache.Get(view_info);
     
-    VkImageViewCreateInfo view_create_info{};
-    view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    view_create_info.image = vk_image;
-    view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    view_create_info.format   = VK_FORMAT_R8G8B8A8_SRGB;
-    view_create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    view_create_info.subresourceRange.baseMipLevel = 0;
-    view_create_info.subresourceRange.levelCount   = 1;
-    view_create_info.subresourceRange.baseArrayLayer = 0;
-    view_create_info.subresourceRange.layerCount     = 1;
-    
-    vkCreateImageView(render::context.vk_device, &view_create_info, nullptr, &vk_view);
+    if(render::bindless_table.IsEnabled()){
+        bindless_index = render::bindless_table.Register(vk_view);
+    }
 }
 void Texture::Terminate(){
-    if(vk_view != VK_NULL_HANDLE){
-        vkDestroyImageView(render::context.vk_device, vk_view, nullptr);
-        vk_view = VK_NULL_HANDLE;
-    }
+    render::bindless_table.Release(bindless_index);
+    bindless_index = BINDLESS_INVALID_INDEX;
+    vk_view = VK_NULL_HANDLE;
     if(vk_image != VK_NULL_HANDLE){
+        render::image_view_cache.Release(vk_image);
         vmaDestroyImage(render::context.allocator, vk_image, vma_allocation);
+        render::memory_budget.Untrack(MEMORY_CATEGORY_TEXTURE, allocation_size);
+        allocation_size = 0;
         vk_image = VK_NULL_HANDLE;
     }
 }
 
-void Texture::WriteDescriptor(VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index){
-    VkDescriptorImageInfo image_info{};
-    image_info.imageView = vk_view;
-    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    image_info.sampler = VK_NULL_HANDLE;
-    
-    VkWriteDescriptorSet set_write{};
-    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    set_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    set_write.descriptorCount = 1;
-    set_write.dstBinding      = binding;
-    set_write.dstArrayElement = index;
-    set_write.dstSet     = descriptor_set;
-    set_write.pImageInfo = &image_info;
-    
-    vkUpdateDescriptorSets(render::context.vk_device, 1, &set_write, 0, nullptr);
+void Texture::WriteDescriptor(DescriptorWriter* writer, VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index){
+    writer->WriteImage(descriptor_set, binding, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                       vk_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_NULL_HANDLE);
+}
+DescriptorData Texture::GetDescriptorData(){
+    DescriptorData data{};
+    data.image.imageView   = vk_view;
+    data.image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    data.image.sampler     = VK_NULL_HANDLE;
+    return data;
 }
 
 
-void Sampler::Initialize(){
+void Sampler::Initialize(SamplerInfo info){
+    vk_sampler = render::sampler_cache.Get(info);
+}
+// The VkSampler Is Owned By The Cache And Lives Until It Terminates
+void Sampler::Terminate(){
+    vk_sampler = VK_NULL_HANDLE;
+}
+
+void Sampler::WriteDescriptor(DescriptorWriter* writer, VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index){
+    writer->WriteImage(descriptor_set, binding, index, VK_DESCRIPTOR_TYPE_SAMPLER,
+                       VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED, vk_sampler);
+}
+DescriptorData Sampler::GetDescriptorData(){
+    DescriptorData data{};
+    data.image.imageView   = VK_NULL_HANDLE;
+    data.image.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    data.image.sampler     = vk_sampler;
+    return data;
+}
+
+SamplerCache sampler_cache{};
+void SamplerCache::Initialize(){}
+void SamplerCache::Terminate(){
+    for(auto& [key, vk_sampler] : sampler_map){
+        vkDestroySampler(render::context.vk_device, vk_sampler, nullptr);
+    }
+    sampler_map.clear();
+}
+VkSampler SamplerCache::Get(SamplerInfo info){
+    // Anisotropy Is Clamped Before Keying So Requests Beyond The Device Limit Share A Sampler
+    info.max_anisotropy = std::min(info.max_anisotropy, render::context.max_sampler_anisotropy);
+    if(info.max_anisotropy <= 1.0f){
+        info.max_anisotropy = 0.0f;
+    }
+    
+    StateKey key{};
+    key.words.emplace_back(((uint64_t)info.mag_filter << 32) | (uint64_t)info.min_filter);
+    key.words.emplace_back(((uint64_t)info.mipmap_mode << 32) | (uint64_t)info.address_mode_u);
+    key.words.emplace_back(((uint64_t)info.address_mode_v << 32) | (uint64_t)info.address_mode_w);
+    uint32_t float_bits[4];
+    memcpy(&float_bits[0], &info.max_anisotropy, sizeof(float));
+    memcpy(&float_bits[1], &info.mip_lod_bias,   sizeof(float));
+    memcpy(&float_bits[2], &info.min_lod,        sizeof(float));
+    memcpy(&float_bits[3], &info.max_lod,        sizeof(float));
+    key.words.emplace_back(((uint64_t)float_bits[0] << 32) | (uint64_t)float_bits[1]);
+    key.words.emplace_back(((uint64_t)float_bits[2] << 32) | (uint64_t)float_bits[3]);
+    key.Finalize();
+    
+    std::lock_guard<std::mutex> lock(sampler_map_mutex);
+    auto iterator = sampler_map.find(key);
+    if(iterator != sampler_map.end()){
+        return iterator->second;
+    }
+    
     VkSamplerCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     create_info.flags = 0;
     create_info.pNext = nullptr;
-    //create_info.borderColor = {};
-    //create_info.
-    vkCreateSampler(render::context.vk_device, &create_info, nullptr, &vk_sampler);
-}
-void Sampler::Terminate(){
-    vkDestroySampler(render::context.vk_device, vk_sampler, nullptr);
+    create_info.magFilter    = info.mag_filter;
+    create_info.minFilter    = info.min_filter;
+    create_info.mipmapMode   = info.mipmap_mode;
+    create_info.addressModeU = info.address_mode_u;
+    create_info.addressModeV = info.address_mode_v;
+    create_info.addressModeW = info.address_mode_w;
+    create_info.mipLodBias   = info.mip_lod_bias;
+    create_info.anisotropyEnable = info.max_anisotropy > 0.0f ? VK_TRUE : VK_FALSE;
+    create_info.maxAnisotropy    = info.max_anisotropy;
+    create_info.minLod = info.min_lod;
+    create_info.maxLod = info.max_lod;
+    VkSampler vk_sampler;
+    VkResult vk_result = vkCreateSampler(render::context.vk_device, &create_info, nullptr, &vk_sampler);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE SAMPLER");
+    }
+    sampler_map.emplace(std::move(key), vk_sampler);
+    return vk_sampler;
 }
 
-void Sampler::WriteDescriptor(VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index){
-    VkDescriptorImageInfo image_info{};
-    image_info.imageView   = VK_NULL_HANDLE;
-    image_info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.sampler = vk_sampler;
+ImageViewCache image_view_cache{};
+void ImageViewCache::Initialize(){}
+void ImageViewCache::Terminate(){
+    for(auto& [key, vk_view] : view_map){
+        vkDestroyImageView(render::context.vk_device, vk_view, nullptr);
+    }
+    view_map.clear();
+    image_view_keys.clear();
+}
+VkImageView ImageViewCache::Get(ImageViewInfo info){
+    StateKey key{};
+    key.words.emplace_back((uint64_t)info.vk_image);
+    key.words.emplace_back(((uint64_t)info.view_type << 32) | (uint64_t)info.format);
+    key.words.emplace_back(((uint64_t)info.aspect_mask << 32) | (uint64_t)info.base_mip_level);
+    key.words.emplace_back(((uint64_t)info.level_count << 32) | (uint64_t)info.base_array_layer);
+    key.words.emplace_back(info.layer_count);
+    key.Finalize();
     
-    VkWriteDescriptorSet set_write{};
-    set_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    set_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-    set_write.descriptorCount = 1;
-    set_write.dstBinding      = binding;
-    set_write.dstArrayElement = index;
-    set_write.dstSet     = descriptor_set;
-    set_write.pImageInfo = &image_info;
+    std::lock_guard<std::mutex> lock(view_map_mutex);
+    auto iterator = view_map.find(key);
+    if(iterator != view_map.end()){
+        return iterator->second;
+    }
     
-    vkUpdateDescriptorSets(render::context.vk_device, 1, &set_write, 0, nullptr);
+    VkImageViewCreateInfo view_create_info{};
+    view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_create_info.image    = info.vk_image;
+    view_create_info.viewType = info.view_type;
+    view_create_info.format   = info.format;
+    view_create_info.subresourceRange.aspectMask     = info.aspect_mask;
+    view_create_info.subresourceRange.baseMipLevel   = info.base_mip_level;
+    view_create_info.subresourceRange.levelCount     = info.level_count;
+    view_create_info.subresourceRange.baseArrayLayer = info.base_array_layer;
+    view_create_info.subresourceRange.layerCount     = info.layer_count;
+    VkImageView vk_view;
+    VkResult vk_result = vkCreateImageView(render::context.vk_device, &view_create_info, nullptr, &vk_view);
+    if(vk_result != VK_SUCCESS){
+        throw std::runtime_error("FAILED TO CREATE IMAGE VIEW");
+    }
+    image_view_keys[info.vk_image].emplace_back(key);
+    view_map.emplace(std::move(key), vk_view);
+    return vk_view;
+}
+void ImageViewCache::Release(VkImage vk_image){
+    std::lock_guard<std::mutex> lock(view_map_mutex);
+    auto iterator = image_view_keys.find(vk_image);
+    if(iterator == image_view_keys.end()){
+        return;
+    }
+    for(const StateKey& key : iterator->second){
+        auto view_iterator = view_map.find(key);
+        vkDestroyImageView(render::context.vk_device, view_iterator->second, nullptr);
+        view_map.erase(view_iterator);
+    }
+    image_view_keys.erase(iterator);
 }
 }
@@ -1,5 +1,12 @@
 #pragma once
 #include "render/context.h"
+#include "render/descriptor.h"
+#include "render/hash.h"
+#include "render/resource_state.h"
+#include "render/memory_budget.h"
+
+#include <mutex>
+#include <unordered_map>
 
 namespace render{
 struct MemoryAllocation;
@@ -19,6 +26,7 @@ struct ImageRegion{
 };
 struct TextureInfo{
     ImageExtent extent;
+    uint32_t    mip_levels = 1;
 };
 class Texture{
 public:
@@ -28,21 +36,80 @@ public:
     void Initialize(TextureInfo info);
     void Terminate();
     
-    void WriteDescriptor(VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index);
+    void WriteDescriptor(DescriptorWriter* writer, VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index);
+    DescriptorData GetDescriptorData();
     
     ImageExtent   image_extent;
+    uint32_t      bindless_index = UINT32_MAX;
+    uint32_t      mip_levels   = 1;
+    uint32_t      array_layers = 1;
+    // Indexed By layer * mip_levels + mip
+    std::vector<ResourceState> subresource_states{};
     VmaAllocation vma_allocation;
+    VkDeviceSize  allocation_size = 0;
     VkImage       vk_image;
     VkImageView   vk_view;
 };
 
+// Defaults Match A Zero Initialized VkSamplerCreateInfo
+struct SamplerInfo{
+    VkFilter mag_filter = VK_FILTER_NEAREST;
+    VkFilter min_filter = VK_FILTER_NEAREST;
+    VkSamplerMipmapMode  mipmap_mode    = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    float max_anisotropy = 0.0f;
+    float mip_lod_bias   = 0.0f;
+    float min_lod        = 0.0f;
+    float max_lod        = 0.0f;
+};
 class Sampler{
 public:
-    void Initialize();
+    void Initialize(SamplerInfo info = {});
     void Terminate();
     
-    void WriteDescriptor(VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index);
+    void WriteDescriptor(DescriptorWriter* writer, VkDescriptorSet descriptor_set, uint32_t binding, uint32_t index);
+    DescriptorData GetDescriptorData();
     
     VkSampler vk_sampler;
 };
+
+// Identical Sampler Requests Share One VkSampler, Keeping Well Under maxSamplerAllocationCount
+class SamplerCache{
+public:
+    void Initialize();
+    void Terminate();
+    
+    VkSampler Get(SamplerInfo info);
+    
+    std::mutex sampler_map_mutex;
+    std::unordered_map<StateKey, VkSampler, StateKeyHash> sampler_map;
+};
+extern SamplerCache sampler_cache;
+
+struct ImageViewInfo{
+    VkImage            vk_image;
+    VkImageViewType    view_type = VK_IMAGE_VIEW_TYPE_2D;
+    VkFormat           format;
+    VkImageAspectFlags aspect_mask      = VK_IMAGE_ASPECT_COLOR_BIT;
+    uint32_t           base_mip_level   = 0;
+    uint32_t           level_count      = 1;
+    uint32_t           base_array_layer = 0;
+    uint32_t           layer_count      = 1;
+};
+// Views Are Shared Per Image And Subresource, And Destroyed Together When Their Image Is Released
+class ImageViewCache{
+public:
+    void Initialize();
+    void Terminate();
+    
+    VkImageView Get(ImageViewInfo info);
+    void Release(VkImage vk_image);
+    
+    std::mutex view_map_mutex;
+    std::unordered_map<StateKey, VkImageView, StateKeyHash> view_map;
+    std::unordered_map<VkImage, std::vector<StateKey>> image_view_keys;
+};
+extern ImageViewCache image_view_cache;
 }
@@ -0,0 +1,278 @@
+#include "render/texture_streaming.h"
+#include "render/staging.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+namespace render{
+static float SrgbToLinear(uint8_t value){
+    const float srgb = value / 255.0f;
+    return srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+}
+static uint8_t LinearToSrgb(float linear){
+    const float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+    return (uint8_t)std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f);
+}
+// Colour Channels Are Averaged In Linear Space To Match The sRGB Image Format, Alpha Is Already Linear
+std::vector<TextureMip> GenerateMipChain(ImageExtent extent, const uint8_t* pixels){
+    PROFILE_FUNCTION();
+    static float srgb_to_linear[256];
+    static std::once_flag srgb_table_flag;
+    std::call_once(srgb_table_flag, []{
+        for(uint32_t value = 0; value < 256; value++){
+            srgb_to_linear[value] = SrgbToLinear((uint8_t)value);
+        }
+    });
+    std::vector<TextureMip> mips;
+    mips.push_back({ extent, std::vector<uint8_t>(pixels, pixels + (size_t)extent.width * extent.height * 4) });
+    while(mips.back().extent.width > 1 || mips.back().extent.height > 1){
+        const TextureMip& source = mips.back();
+        ImageExtent mip_extent = { std::max(source.extent.width / 2, 1u), std::max(source.extent.height / 2, 1u), 1 };
+        std::vector<uint8_t> mip_pixels((size_t)mip_extent.width * mip_extent.height * 4);
+        for(uint32_t y = 0; y < mip_extent.height; y++){
+            const uint32_t y0 = std::min(y * 2,     source.extent.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, source.extent.height - 1);
+            for(uint32_t x = 0; x < mip_extent.width; x++){
+                const uint32_t x0 = std::min(x * 2,     source.extent.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, source.extent.width - 1);
+                const uint8_t* p00 = &source.pixels[((size_t)y0 * source.extent.width + x0) * 4];
+                const uint8_t* p01 = &source.pixels[((size_t)y0 * source.extent.width + x1) * 4];
+                const uint8_t* p10 = &source.pixels[((size_t)y1 * source.extent.width + x0) * 4];
+                const uint8_t* p11 = &source.pixels[((size_t)y1 * source.extent.width + x1) * 4];
+                uint8_t* destination = &mip_pixels[((size_t)y * mip_extent.width + x) * 4];
+                for(uint32_t channel = 0; channel < 3; channel++){
+                    const float linear = srgb_to_linear[p00[channel]] + srgb_to_linear[p01[channel]] +
+                                         srgb_to_linear[p10[channel]] + srgb_to_linear[p11[channel]];
+                    destination[channel] = LinearToSrgb(linear * 0.25f);
+                }
+                destination[3] = (uint8_t)((p00[3] + p01[3] + p10[3] + p11[3] + 2) / 4);
+            }
+        }
+        mips.push_back({ mip_extent, std::move(mip_pixels) });
+    }
+    return mips;
+}
+
+TextureStreamer texture_streamer{};
+void TextureStreamer::Initialize(TextureStreamerInfo info){
+    info_ = info;
+}
+void TextureStreamer::Terminate(){
+    render::staging_manager.AwaitUploadCompletion();
+    for(StreamingTexture* texture : textures_){
+        render::memory_budget.UnregisterEvictable(texture->evictable);
+        if(texture->pending_mip != UINT32_MAX){
+            texture->pending_texture.Terminate();
+        }
+        texture->texture.Terminate();
+        delete texture;
+    }
+    for(RetiredTexture& retired : retired_textures_){
+        retired.texture.Terminate();
+    }
+    textures_.clear();
+    pending_textures_.clear();
+    retired_textures_.clear();
+}
+
+StreamingTexture* TextureStreamer::Create(ImageExtent extent, const uint8_t* pixels){
+    PROFILE_FUNCTION();
+    StreamingTexture* texture = new StreamingTexture{};
+    texture->mips = GenerateMipChain(extent, pixels);
+
+    texture->base_mip = (uint32_t)texture->mips.size() - 1;
+    for(uint32_t mip = 0; mip < texture->mips.size(); mip++){
+        const ImageExtent& mip_extent = texture->mips[mip].extent;
+        if(std::max(mip_extent.width, mip_extent.height) <= info_.resident_mip_size){
+            texture->base_mip = mip;
+            break;
+        }
+    }
+
+    // Coarse Levels Join The Caller's Upload Batch So The Texture Is Usable As Soon As It Is Submitted
+    const uint32_t level_count = (uint32_t)texture->mips.size() - texture->base_mip;
+    texture->texture.Initialize({ texture->mips[texture->base_mip].extent, level_count });
+    for(uint32_t level = 0; level < level_count; level++){
+        const TextureMip& mip = texture->mips[texture->base_mip + level];
+        void* staging_pointer = render::staging_manager.UploadToImage(mip.pixels.size(), &texture->texture, level);
+        std::memcpy(staging_pointer, mip.pixels.data(), mip.pixels.size());
+    }
+    texture->resident_mip = texture->base_mip;
+    textures_.emplace_back(texture);
+    statistics.texture_count++;
+    return texture;
+}
+void TextureStreamer::Destroy(StreamingTexture* texture){
+    render::memory_budget.UnregisterEvictable(texture->evictable);
+    if(texture->pending_mip != UINT32_MAX){
+        render::staging_manager.AwaitUploadCompletion();
+        texture->pending_texture.Terminate();
+        pending_textures_.erase(std::find(pending_textures_.begin(), pending_textures_.end(), texture));
+    }
+    retired_textures_.push_back({ texture->texture, frame_ });
+    textures_.erase(std::find(textures_.begin(), textures_.end(), texture));
+    statistics.texture_count--;
+    delete texture;
+}
+
+void TextureStreamer::Request(StreamingTexture* texture, uint32_t mip){
+    uint32_t current = texture->requested_mip.load(std::memory_order_relaxed);
+    while(mip < current && !texture->requested_mip.compare_exchange_weak(current, mip, std::memory_order_relaxed)){}
+}
+uint32_t TextureStreamer::MipForScreenSize(const StreamingTexture* texture, float screen_size){
+    const ImageExtent& extent = texture->mips[0].extent;
+    const float texel_ratio = (float)std::max(extent.width, extent.height) / std::max(screen_size, 1.0f);
+    const uint32_t last_mip = (uint32_t)texture->mips.size() - 1;
+    if(texel_ratio <= 1.0f){
+        return 0;
+    }
+    return std::min((uint32_t)std::floor(std::log2(texel_ratio)), last_mip);
+}
+
+VkDeviceSize TextureStreamer::MipChainBytes(const StreamingTexture* texture, uint32_t first_mip, uint32_t end_mip){
+    VkDeviceSize bytes = 0;
+    for(uint32_t mip = first_mip; mip < std::min(end_mip, (uint32_t)texture->mips.size()); mip++){
+        bytes += texture->mips[mip].pixels.size();
+    }
+    return bytes;
+}
+// The Replacement Holds Every Level From resident_mip Down; Levels The Current Image Already Has
+// Are Copied On The GPU And Only Finer Ones Are Staged From The CPU Chain
+void TextureStreamer::BeginRebuild(StreamingTexture* texture, uint32_t resident_mip){
+    PROFILE_FUNCTION();
+    const uint32_t level_count = (uint32_t)texture->mips.size() - resident_mip;
+    texture->pending_texture.Initialize({ texture->mips[resident_mip].extent, level_count });
+    for(uint32_t mip = resident_mip; mip < texture->mips.size(); mip++){
+        if(mip >= texture->resident_mip){
+            render::staging_manager.CopyImage(&texture->texture, mip - texture->resident_mip,
+                                              &texture->pending_texture, mip - resident_mip);
+            continue;
+        }
+        const TextureMip& source = texture->mips[mip];
+        void* staging_pointer = render::staging_manager.UploadToImage(source.pixels.size(), &texture->pending_texture,
+                                                                      mip - resident_mip);
+        std::memcpy(staging_pointer, source.pixels.data(), source.pixels.size());
+    }
+    texture->pending_mip = resident_mip;
+    pending_textures_.emplace_back(texture);
+    statistics.uploaded_bytes += MipChainBytes(texture, resident_mip, texture->resident_mip);
+}
+// Only Levels Finer Than The Base Can Be Given Back, Eviction Drops The Texture To Its Base Mips,
+// So Only Those Levels' Bytes Count As Freed
+void TextureStreamer::RegisterEvictable(StreamingTexture* texture){
+    render::memory_budget.UnregisterEvictable(texture->evictable);
+    texture->evictable = EVICTABLE_INVALID_HANDLE;
+    if(texture->resident_mip >= texture->base_mip){
+        return;
+    }
+    const VkDeviceSize dropped_bytes = MipChainBytes(texture, texture->resident_mip, texture->base_mip);
+    texture->evictable = render::memory_budget.RegisterEvictable(MEMORY_CATEGORY_TEXTURE, dropped_bytes,
+                                                                  [texture]{
+        texture->evicted   = true;
+        texture->evictable = EVICTABLE_INVALID_HANDLE;
+    });
+}
+
+void TextureStreamer::Update(uint64_t frame){
+    PROFILE_FUNCTION();
+    frame_ = frame;
+    static core::MetricCounter* streamed_in_counter = core::metrics.Counter("texture_mips_streamed_in");
+    static core::MetricCounter* dropped_counter     = core::metrics.Counter("texture_mips_dropped");
+    static core::MetricCounter* uploaded_counter    = core::metrics.Counter("texture_stream_uploaded_bytes");
+
+    for(auto iterator = retired_textures_.begin(); iterator != retired_textures_.end();){
+        if(iterator->frame + info_.frame_count > frame){
+            ++iterator;
+            continue;
+        }
+        iterator->texture.Terminate();
+        iterator = retired_textures_.erase(iterator);
+    }
+
+    // Replacements Become Visible Only Once Their Upload Has Completed, Frames Recorded Before Keep The Old Image
+    if(!pending_textures_.empty() && !render::staging_manager.recording && render::staging_manager.IsUploadComplete()){
+        for(StreamingTexture* texture : pending_textures_){
+            if(texture->pending_mip < texture->resident_mip){
+                statistics.streamed_in_count += texture->resident_mip - texture->pending_mip;
+                streamed_in_counter->Add(texture->resident_mip - texture->pending_mip);
+            }
+            else{
+                statistics.dropped_count += texture->pending_mip - texture->resident_mip;
+                dropped_counter->Add(texture->pending_mip - texture->resident_mip);
+            }
+            retired_textures_.push_back({ texture->texture, frame });
+            texture->texture      = texture->pending_texture;
+            texture->resident_mip = texture->pending_mip;
+            texture->pending_mip  = UINT32_MAX;
+            RegisterEvictable(texture);
+        }
+        pending_textures_.clear();
+    }
+    // Recording While An Earlier Batch Is In Flight Would Block On It
+    const bool can_upload = pending_textures_.empty() && render::staging_manager.IsUploadComplete();
+    const VkDeviceSize uploaded_bytes_before = statistics.uploaded_bytes;
+
+    struct StreamCandidate{
+        StreamingTexture* texture;
+        uint32_t wanted_mip;
+    };
+    std::vector<StreamCandidate> candidates;
+    for(StreamingTexture* texture : textures_){
+        const uint32_t requested = texture->requested_mip.exchange(UINT32_MAX, std::memory_order_relaxed);
+        const uint32_t wanted    = std::min(requested, texture->base_mip);
+        if(requested != UINT32_MAX){
+            render::memory_budget.Touch(texture->evictable);
+        }
+        if(wanted <= texture->resident_mip){
+            texture->last_needed_frame = frame;
+        }
+        if(!can_upload){
+            continue;
+        }
+        if(texture->evicted){
+            texture->evicted = false;
+            if(texture->resident_mip < texture->base_mip){
+                BeginRebuild(texture, texture->base_mip);
+            }
+        }
+        else if(wanted < texture->resident_mip){
+            candidates.push_back({ texture, wanted });
+        }
+        else if(wanted > texture->resident_mip && texture->last_needed_frame + info_.drop_delay_frames <= frame){
+            BeginRebuild(texture, wanted);
+        }
+    }
+
+    // Textures Furthest From Their Wanted Detail Go First; Ones That Do Not Fit Step Up Fewer Levels
+    std::sort(candidates.begin(), candidates.end(), [](const StreamCandidate& a, const StreamCandidate& b){
+        return a.texture->resident_mip - a.wanted_mip > b.texture->resident_mip - b.wanted_mip;
+    });
+    VkDeviceSize uploaded_bytes = 0;
+    for(const StreamCandidate& candidate : candidates){
+        StreamingTexture* texture = candidate.texture;
+        uint32_t target_mip = candidate.wanted_mip;
+        while(target_mip + 1 < texture->resident_mip &&
+              uploaded_bytes + MipChainBytes(texture, target_mip, texture->resident_mip) > info_.upload_bytes_per_frame){
+            target_mip++;
+        }
+        // Resident Levels Are Copied On The GPU, Only The New Ones Count Against The Upload Budget
+        const VkDeviceSize bytes = MipChainBytes(texture, target_mip, texture->resident_mip);
+        // A Single Step Larger Than The Budget Still Goes Through When Nothing Else Was Uploaded
+        if(uploaded_bytes > 0 && uploaded_bytes + bytes > info_.upload_bytes_per_frame){
+            break;
+        }
+        // Each Level Is Aligned Within The Staging Buffer
+        if(bytes + 16 * texture->mips.size() > render::staging_manager.Available() ||
+           !render::memory_budget.Fits(MEMORY_CATEGORY_TEXTURE, MipChainBytes(texture, target_mip))){
+            continue;
+        }
+        BeginRebuild(texture, target_mip);
+        uploaded_bytes += bytes;
+    }
+
+    uploaded_counter->Add(statistics.uploaded_bytes - uploaded_bytes_before);
+}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "render/texture.h"
+#include "render/memory_budget.h"
+
+namespace render{
+struct TextureMip{
+    ImageExtent extent;
+    std::vector<uint8_t> pixels;
+};
+// Box Filters An sRGB RGBA8 Image Down To 1x1, Element 0 Is The Source Image
+std::vector<TextureMip> GenerateMipChain(ImageExtent extent, const uint8_t* pixels);
+
+struct TextureStreamerInfo{
+    uint32_t frame_count = 2;
+    // Mips No Larger Than This Are Uploaded At Creation And Never Dropped
+    uint32_t resident_mip_size = 64;
+    VkDeviceSize upload_bytes_per_frame = 16 * 1024 * 1024;
+    // Frames A Texture Must Go Without Needing Its Finest Resident Mip Before It Is Dropped
+    uint32_t drop_delay_frames = 120;
+};
+
+// The CPU Keeps The Whole Mip Chain, The GPU Image Holds resident_mip And Every Coarser Level
+struct StreamingTexture{
+    std::vector<TextureMip> mips;
+    Texture texture{};
+    uint32_t resident_mip = 0;
+    // Coarsest Level That Is Always Resident
+    uint32_t base_mip     = 0;
+    std::atomic<uint32_t> requested_mip = UINT32_MAX;
+    uint64_t last_needed_frame = 0;
+
+    // Image Being Uploaded, Swapped In Once The Upload Fence Signals
+    Texture  pending_texture{};
+    uint32_t pending_mip = UINT32_MAX;
+
+    EvictableHandle evictable = EVICTABLE_INVALID_HANDLE;
+    bool evicted = false;
+};
+struct TextureStreamingStatistics{
+    uint32_t texture_count;
+    uint32_t streamed_in_count;
+    uint32_t dropped_count;
+    VkDeviceSize uploaded_bytes;
+};
+
+// Textures Start With Only Their Coarse Mips Resident; Draws Request The Finest Mip They Need,
+// Update Streams Finer Levels Through The Staging Manager Within A Per Frame Budget And Drops
+// Levels That Went Unused Or Were Evicted By The Memory Budget
+class TextureStreamer{
+public:
+    void Initialize(TextureStreamerInfo info = {});
+    void Terminate();
+
+    StreamingTexture* Create(ImageExtent extent, const uint8_t* pixels);
+    void Destroy(StreamingTexture* texture);
+
+    // Safe From Any Thread, The Finest Request Made During A Frame Wins
+    void Request(StreamingTexture* texture, uint32_t mip);
+    // Level Whose Texel Density Matches The Texture Spanning screen_size Pixels Along Its Largest Axis
+    static uint32_t MipForScreenSize(const StreamingTexture* texture, float screen_size);
+
+    // Called On The Main Thread After memory_budget.BeginFrame, Uploads Are Recorded Into The
+    // Staging Manager's Open Batch And Go Out With The Caller's SubmitUpload
+    void Update(uint64_t frame);
+
+    TextureStreamingStatistics statistics{};
+
+private:
+    void BeginRebuild(StreamingTexture* texture, uint32_t resident_mip);
+    void RegisterEvictable(StreamingTexture* texture);
+    VkDeviceSize MipChainBytes(const StreamingTexture* texture, uint32_t first_mip, uint32_t end_mip = UINT32_MAX);
+
+    struct RetiredTexture{
+        Texture  texture;
+        uint64_t frame;
+    };
+    TextureStreamerInfo info_{};
+    uint64_t frame_ = 0;
+    std::vector<StreamingTexture*> textures_{};
+    std::vector<StreamingTexture*> pending_textures_{};
+    std::vector<RetiredTexture>    retired_textures_{};
+};
+extern TextureStreamer texture_streamer;
+}
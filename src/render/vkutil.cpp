@@ -17,6 +17,31 @@ std::vector<const char*> ValidateInstanceExtensionSupport(std::vector<const char
     delete[] extension_properties;
     return extension_names;
 }
+bool DeviceExtensionSupported(VkPhysicalDevice vk_physical_device, const char* extension_name){
+    uint32_t extension_property_count = 0;
+    vkEnumerateDeviceExtensionProperties(vk_physical_device, nullptr, &extension_property_count, nullptr);
+    std::vector<VkExtensionProperties> extension_properties(extension_property_count);
+    vkEnumerateDeviceExtensionProperties(vk_physical_device, nullptr, &extension_property_count,
+                                         extension_properties.data());
+    for(const VkExtensionProperties& properties : extension_properties){
+        if(strcmp(properties.extensionName, extension_name) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+bool InstanceLayerSupported(const char* layer_name){
+    uint32_t layer_property_count = 0;
+    vkEnumerateInstanceLayerProperties(&layer_property_count, nullptr);
+    std::vector<VkLayerProperties> layer_properties(layer_property_count);
+    vkEnumerateInstanceLayerProperties(&layer_property_count, layer_properties.data());
+    for(const VkLayerProperties& properties : layer_properties){
+        if(strcmp(properties.layerName, layer_name) == 0){
+            return true;
+        }
+    }
+    return false;
+}
 VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
     if (func != nullptr) {
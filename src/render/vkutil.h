@@ -1,9 +1,12 @@
 #pragma once
 #include <vector>
+#include <cstring>
 #include "vulkan/vulkan.h"
 
 namespace vkutil{
 std::vector<const char*> ValidateInstanceExtensionSupport(std::vector<const char*> extension_names);
+bool DeviceExtensionSupported(VkPhysicalDevice vk_physical_device, const char* extension_name);
+bool InstanceLayerSupported(const char* layer_name);
 
 VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
 void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator);
@@ -1,4 +1,6 @@
 #include "thread_pool.h"
+#include "profiler.h"
+#include "metrics.h"
 
 namespace core{
 Threadpool threadpool{};
@@ -14,7 +16,7 @@ void Threadpool::Terminate(){
     active = false;
     dispatch_mutex.lock();
     for(uint32_t i = 0; i < thread_vector.size(); i++){
-        dispatch_queue.emplace_back([]{ return TASK_COMPLETE; });
+        dispatch_queue.push_back({ []{ return TASK_COMPLETE; }, std::chrono::steady_clock::now() });
     }
     dispatch_mutex.unlock();
     dispatch_condition_variable.notify_all();
@@ -25,9 +27,11 @@ void Threadpool::Terminate(){
 }
 
 void Threadpool::Dispatch(std::function<TaskState()> function){
+    static core::MetricGauge* queue_depth_gauge = core::metrics.Gauge("threadpool_queue_depth");
     dispatch_mutex.lock();
     
-    dispatch_queue.emplace_back(function);
+    dispatch_queue.push_back({ function, std::chrono::steady_clock::now() });
+    queue_depth_gauge->Set((double)dispatch_queue.size());
     
     dispatch_mutex.unlock();
     
@@ -36,23 +40,29 @@ void Threadpool::Dispatch(std::function<TaskState()> function){
 
 
 void Threadpool::HandleDispatch(){
+    PROFILE_THREAD("Threadpool Worker");
+    static core::MetricHistogram* task_latency_histogram = core::metrics.Histogram("threadpool_task_latency_us");
+    static core::MetricGauge*     queue_depth_gauge      = core::metrics.Gauge("threadpool_queue_depth");
     while(active){
         std::unique_lock<std::mutex> lock(dispatch_mutex);
         dispatch_condition_variable.wait(lock, [this]{ return dispatch_queue.size() > 0; });
         
-        std::function<TaskState()> function;
-        function = dispatch_queue.front();
+        Task task = std::move(dispatch_queue.front());
         dispatch_queue.pop_front();
+        queue_depth_gauge->Set((double)dispatch_queue.size());
         
         lock.unlock();
         
-        switch(function()){
+        switch(task.function()){
             case TASK_COMPLETE:{
+                // Dispatch To Completion, Including Time Spent Queued
+                task_latency_histogram->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - task.dispatch_time).count());
                 break;
             }
             case TASK_NOT_READY:{
                 lock.lock();
-                dispatch_queue.emplace_back(function);
+                dispatch_queue.emplace_back(std::move(task));
                 lock.unlock();
                 break;
             }
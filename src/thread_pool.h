@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <mutex>
@@ -12,6 +13,11 @@ public:
         TASK_COMPLETE,
         TASK_NOT_READY,
     };
+    // Dispatch Time Is Kept Across Requeues So Latency Covers Every TASK_NOT_READY Retry
+    struct Task{
+        std::function<TaskState()> function;
+        std::chrono::steady_clock::time_point dispatch_time;
+    };
     
     void Initialize(uint32_t thread_count);
     void Terminate();
@@ -26,7 +32,7 @@ public:
     
     std::mutex dispatch_mutex;
     std::condition_variable dispatch_condition_variable;
-    std::deque<std::function<TaskState()>> dispatch_queue;
+    std::deque<Task> dispatch_queue;
 };
 extern Threadpool threadpool;
 }
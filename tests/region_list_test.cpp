@@ -0,0 +1,88 @@
+#include "render/region_list.h"
+
+#include <cstdio>
+
+static int failure_count = 0;
+#define CHECK(condition) \
+    if(!(condition)){ printf("%s:%d: CHECK FAILED -> %s\n", __FILE__, __LINE__, #condition); failure_count++; }
+
+// Padding Before An Aligned Region Is Left Free Rather Than Handed Out With It
+static void TestAlignmentPadding(){
+    render::RegionList list(0, 100);
+    render::Region region{};
+    CHECK(list.GetRegion(10, 1, &region));
+    CHECK(region.offset == 0 && region.size == 10);
+    
+    CHECK(list.GetRegion(16, 16, &region));
+    CHECK(region.offset == 16 && region.size == 16);
+    CHECK(list.FreeBytes() == 100 - 10 - 16);
+    CHECK(list.LargestFreeRegion() == 100 - 32);
+    
+    // The 6 Byte Padding Gap Fits A Small Unaligned Request
+    CHECK(list.GetRegion(6, 1, &region));
+    CHECK(region.offset == 10 && region.size == 6);
+    CHECK(list.FreeBytes() == 100 - 32);
+    
+    CHECK(!list.GetRegion(100, 1, &region));
+}
+
+// Freed Regions Merge With The Previous Neighbour, The Next Neighbour, Or Both At Once
+static void TestFreeMerging(){
+    render::RegionList list(0, 100);
+    render::Region a{}, b{}, c{}, d{};
+    CHECK(list.GetRegion(10, 1, &a));
+    CHECK(list.GetRegion(10, 1, &b));
+    CHECK(list.GetRegion(10, 1, &c));
+    CHECK(list.GetRegion(10, 1, &d));
+    CHECK(list.FreeBytes() == 60);
+    
+    // No Free Neighbour Touches b
+    list.FreeRegion(b);
+    CHECK(list.FreeBytes() == 70);
+    CHECK(list.LargestFreeRegion() == 60);
+    
+    // a Touches b On Its Right
+    list.FreeRegion(a);
+    CHECK(list.LargestFreeRegion() == 60);
+    CHECK(list.FreeBytes() == 80);
+    
+    // d Touches The Tail On Its Right
+    list.FreeRegion(d);
+    CHECK(list.LargestFreeRegion() == 70);
+    CHECK(list.FreeBytes() == 90);
+    
+    // c Touches [a, b] On Its Left And [d, tail] On Its Right, Leaving One Region
+    list.FreeRegion(c);
+    CHECK(list.FreeBytes() == 100);
+    CHECK(list.LargestFreeRegion() == 100);
+    CHECK(list.Fragmentation() == 0.0f);
+    
+    render::Region whole{};
+    CHECK(list.GetRegion(100, 1, &whole));
+    CHECK(whole.offset == 0 && whole.size == 100);
+}
+
+// Merging Must Also Work When The Freed Region Fills An Alignment Padding Gap
+static void TestFreeMergingAcrossPadding(){
+    render::RegionList list(0, 64);
+    render::Region a{}, b{};
+    CHECK(list.GetRegion(4, 1, &a));
+    CHECK(list.GetRegion(8, 16, &b));
+    CHECK(b.offset == 16);
+    list.FreeRegion(b);
+    list.FreeRegion(a);
+    CHECK(list.FreeBytes() == 64);
+    CHECK(list.LargestFreeRegion() == 64);
+}
+
+int main(){
+    TestAlignmentPadding();
+    TestFreeMerging();
+    TestFreeMergingAcrossPadding();
+    if(failure_count != 0){
+        printf("%d CHECKS FAILED\n", failure_count);
+        return 1;
+    }
+    printf("ALL CHECKS PASSED\n");
+    return 0;
+}